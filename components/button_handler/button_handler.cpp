@@ -1,30 +1,116 @@
 #include "button_handler.h"
 
+#include <algorithm>
+
 #include "esp_log.h"
 #include "freertos/task.h"
 
-static constexpr uint32_t kDebounceDelayMs = 50;
+static constexpr uint32_t kRepeatDelayMs = 500;
+static constexpr uint32_t kRepeatIntervalMs = 200;
+static constexpr uint32_t kMinRepeatIntervalMs = 30;
 static const char* kTag = "button_handler";
 
 using hla::ButtonHandler;
 
-ButtonHandler::ButtonHandler(const std::vector<gpio_num_t>& buttonPins)
-    : mActiveButtonIndex(-1) {
+static std::vector<ButtonHandler::ButtonConfig>
+toConfigs(const std::vector<gpio_num_t>& buttonPins) {
+    std::vector<ButtonHandler::ButtonConfig> configs;
     for (const auto& pin : buttonPins) {
-        gpio_config_t io_conf = {};
-        io_conf.pin_bit_mask = 1ULL << pin;
-        io_conf.mode = GPIO_MODE_INPUT;
-        io_conf.pull_up_en = GPIO_PULLUP_ENABLE;
-        io_conf.pull_down_en = GPIO_PULLDOWN_DISABLE;
-        io_conf.intr_type = GPIO_INTR_DISABLE;
-        gpio_config(&io_conf);
+        configs.push_back({pin});
+    }
+    return configs;
+}
+
+ButtonHandler::ButtonHandler(const std::vector<gpio_num_t>& buttonPins)
+    : ButtonHandler(toConfigs(buttonPins)) {}
 
+ButtonHandler::ButtonHandler(const std::vector<ButtonConfig>& buttons)
+    : mActiveButtonIndex(-1), mEventQueue(nullptr), mRepeatTimer(nullptr),
+      mRepeatIntervalMs(kRepeatIntervalMs) {
+    // the ISR and the timers get pointers to the buttons, so the vector must
+    // not grow afterwards
+    mButtons.reserve(buttons.size());
+    for (const auto& config : buttons) {
         Button btn;
-        btn.gpio = pin;
+        btn.handler = this;
+        btn.index = mButtons.size();
+        btn.gpio = config.gpio;
+        btn.debounceMs = config.debounceMs;
         mButtons.push_back(btn);
     }
+}
+
+bool ButtonHandler::initialize() {
+    // one event per button and one for auto-repeat
+    mEventQueue = xQueueCreate(mButtons.size() + 1, sizeof(Event));
+    if (!mEventQueue) {
+        ESP_LOGE(kTag, "Failed to create event queue");
+        return false;
+    }
+
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = repeatTimerCallback;
+    timerArgs.arg = this;
+    timerArgs.name = "button_repeat";
+    esp_err_t err = esp_timer_create(&timerArgs, &mRepeatTimer);
+    if (err != ESP_OK) {
+        ESP_LOGE(kTag, "Failed to create repeat timer (%s)",
+                 esp_err_to_name(err));
+        return false;
+    }
+
+    if (xTaskCreate(taskLoop, "button_handler_task", 4096, this, 10,
+                    nullptr) != pdPASS) {
+        ESP_LOGE(kTag, "Failed to create task");
+        return false;
+    }
 
-    xTaskCreate(taskLoop, "button_handler_task", 4096, this, 10, nullptr);
+    // the service may already be installed by another driver
+    err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(kTag, "Failed to install GPIO ISR service (%s)",
+                 esp_err_to_name(err));
+        return false;
+    }
+    bool result = true;
+    for (auto& button : mButtons) {
+        result = initializeButton(button) && result;
+    }
+    return result;
+}
+
+bool ButtonHandler::initializeButton(Button& button) {
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = debounceTimerCallback;
+    timerArgs.arg = &button;
+    timerArgs.name = "button_debounce";
+    esp_err_t err = esp_timer_create(&timerArgs, &button.debounceTimer);
+    if (err != ESP_OK) {
+        ESP_LOGE(kTag, "GPIO %d: failed to create debounce timer (%s)",
+                 button.gpio, esp_err_to_name(err));
+        return false;
+    }
+
+    gpio_config_t io_conf = {};
+    io_conf.pin_bit_mask = 1ULL << button.gpio;
+    io_conf.mode = GPIO_MODE_INPUT;
+    io_conf.pull_up_en = GPIO_PULLUP_ENABLE;
+    io_conf.pull_down_en = GPIO_PULLDOWN_DISABLE;
+    io_conf.intr_type = GPIO_INTR_ANYEDGE;
+    err = gpio_config(&io_conf);
+    if (err != ESP_OK) {
+        ESP_LOGE(kTag, "GPIO %d: failed to configure (%s)", button.gpio,
+                 esp_err_to_name(err));
+        return false;
+    }
+    // the interrupt is only added once the timer exists, the ISR arms it
+    err = gpio_isr_handler_add(button.gpio, isrHandler, &button);
+    if (err != ESP_OK) {
+        ESP_LOGE(kTag, "GPIO %d: failed to add ISR handler (%s)", button.gpio,
+                 esp_err_to_name(err));
+        return false;
+    }
+    return true;
 }
 
 void ButtonHandler::onButtonPressed(gpio_num_t gpio) {
@@ -35,34 +121,89 @@ void ButtonHandler::onButtonReleased(gpio_num_t gpio) {
     ESP_LOGD(kTag, "Released GPIO %d", gpio);
 }
 
+void ButtonHandler::onButtonRepeated(gpio_num_t gpio) {
+    ESP_LOGD(kTag, "Repeated GPIO %d", gpio);
+}
+
 void ButtonHandler::loop() {
+    Event event;
     while (true) {
-        TickType_t now = xTaskGetTickCount();
-        for (size_t i = 0; i < mButtons.size(); ++i) {
-            int level = gpio_get_level(mButtons[i].gpio);
-            if (level != mButtons[i].lastState) {
-                mButtons[i].lastChangeTime = now;
-                mButtons[i].lastState = level;
-            } else if ((now - mButtons[i].lastChangeTime) >=
-                       pdMS_TO_TICKS(kDebounceDelayMs)) {
-                if (level != mButtons[i].stableState) {
-                    mButtons[i].stableState = level;
-
-                    if (level == 0 && mActiveButtonIndex == -1) {
-                        mActiveButtonIndex = i;
-                        onButtonPressed(mButtons[i].gpio);
-                    } else if (level == 1 && mActiveButtonIndex == (int) i) {
-                        onButtonReleased(mButtons[i].gpio);
-                        mActiveButtonIndex = -1;
-                    }
-                }
-            }
+        if (xQueueReceive(mEventQueue, &event, portMAX_DELAY) != pdTRUE) {
+            continue;
         }
-        vTaskDelay(pdMS_TO_TICKS(10));
+        Button& button = mButtons[event.index];
+        switch (event.type) {
+        case EventType::Edge:
+            esp_timer_start_once(button.debounceTimer,
+                                 button.debounceMs * 1000ULL);
+            break;
+        case EventType::Settled:
+            handleSettled(button);
+            break;
+        case EventType::Repeat:
+            handleRepeat();
+            break;
+        }
+    }
+}
+
+void ButtonHandler::handleSettled(Button& button) {
+    // an edge from now on starts a new debounce time
+    gpio_intr_enable(button.gpio);
+    int level = gpio_get_level(button.gpio);
+    if (level == button.stableState) {
+        return;
+    }
+    button.stableState = level;
+    if (level == 0 && mActiveButtonIndex == -1) {
+        mActiveButtonIndex = button.index;
+        mRepeatIntervalMs = kRepeatIntervalMs;
+        esp_timer_start_once(mRepeatTimer, kRepeatDelayMs * 1000ULL);
+        onButtonPressed(button.gpio);
+    } else if (level == 1 && mActiveButtonIndex == button.index) {
+        esp_timer_stop(mRepeatTimer);
+        onButtonReleased(button.gpio);
+        mActiveButtonIndex = -1;
     }
 }
 
+void ButtonHandler::handleRepeat() {
+    if (mActiveButtonIndex == -1) {
+        return;
+    }
+    // accelerate down to the minimal interval
+    mRepeatIntervalMs =
+        std::max(mRepeatIntervalMs * 3 / 4, kMinRepeatIntervalMs);
+    esp_timer_start_once(mRepeatTimer, mRepeatIntervalMs * 1000ULL);
+    onButtonRepeated(mButtons[mActiveButtonIndex].gpio);
+}
+
 void ButtonHandler::taskLoop(void* param) {
     ButtonHandler* self = static_cast<ButtonHandler*>(param);
     self->loop();
-}
\ No newline at end of file
+}
+
+void ButtonHandler::isrHandler(void* param) {
+    Button* button = static_cast<Button*>(param);
+    Event event = {EventType::Edge, button->index};
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    // the bouncing edges that follow are ignored, the level is sampled once
+    // the debounce time is over
+    gpio_intr_disable(button->gpio);
+    xQueueSendFromISR(button->handler->mEventQueue, &event,
+                      &higherPriorityTaskWoken);
+    portYIELD_FROM_ISR(higherPriorityTaskWoken);
+}
+
+void ButtonHandler::debounceTimerCallback(void* param) {
+    Button* button = static_cast<Button*>(param);
+    Event event = {EventType::Settled, button->index};
+    // every button has at most one event queued, do not block the timer task
+    xQueueSend(button->handler->mEventQueue, &event, 0);
+}
+
+void ButtonHandler::repeatTimerCallback(void* param) {
+    ButtonHandler* self = static_cast<ButtonHandler*>(param);
+    Event event = {EventType::Repeat, 0};
+    xQueueSend(self->mEventQueue, &event, 0);
+}
@@ -2,25 +2,57 @@
 #define button_handler_h
 
 #include "driver/gpio.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
 
 #include <vector>
 
 namespace hla {
 /**
  * @brief Button handler class
- * Button handler is a class used for managing buttons. Gpio pin state and
- * debouncing are implemented with polling. This handler is processing only one
- * button at a time. While one button is pressed others are ignored.
+ * Button handler is a class used for managing buttons. The first edge on a
+ * button pin raises an interrupt that starts the debounce timer of the button
+ * and masks the interrupt, the level is sampled once the debounce time is
+ * over. Nothing runs between presses. This handler is processing only one
+ * button at a time. While one button is pressed others are ignored. While a
+ * button is held down, onButtonRepeated() is called with an increasing rate.
  */
 class ButtonHandler {
   public:
+    static constexpr uint32_t kDefaultDebounceMs = 50;
+
+    /**
+     * @brief Configuration of a button
+     */
+    struct ButtonConfig {
+        gpio_num_t gpio;
+        uint32_t debounceMs = kDefaultDebounceMs;
+    };
+
     /**
      * @brief Constructor
      * @param[in] buttonPins Vector of button gpio pins
      */
     ButtonHandler(const std::vector<gpio_num_t>& buttonPins);
 
+    /**
+     * @brief Constructor
+     * @param[in] buttons Vector of button configurations
+     */
+    ButtonHandler(const std::vector<ButtonConfig>& buttons);
+
+    /**
+     * @brief Set up the interrupts, the timers and the task of the buttons
+     *
+     * The constructor only stores the configuration, so a handler can be a
+     * global object. This must be called once the esp_timer task runs, that
+     * is from app_main() or later.
+     * @return true if all buttons are set up, a button that failed is logged
+     * and stays inactive
+     */
+    bool initialize();
+
   protected:
     /**
      * @brief Function called when when a button is pressed
@@ -35,20 +67,46 @@ class ButtonHandler {
      */
     virtual void onButtonReleased(gpio_num_t gpio);
 
+    /**
+     * @brief Function called repeatedly while a button is held down
+     *
+     * The first call comes after a delay, following calls come faster and
+     * faster, so a long press scrolls quickly without a burst on a short one.
+     * @param[in] gpio gpio pin of the held button
+     */
+    virtual void onButtonRepeated(gpio_num_t gpio);
+
   private:
+    enum class EventType : uint8_t { Edge, Settled, Repeat };
+
+    struct Event {
+        EventType type;
+        uint8_t index;
+    };
+
     struct Button {
+        ButtonHandler* handler;
+        uint8_t index;
         gpio_num_t gpio;
-        int lastState = 1;
+        uint32_t debounceMs;
         int stableState = 1;
-        TickType_t lastChangeTime = 0;
+        esp_timer_handle_t debounceTimer = nullptr;
     };
 
+    bool initializeButton(Button& button);
     void loop();
+    void handleSettled(Button& button);
+    void handleRepeat();
     static void taskLoop(void* param);
+    static void isrHandler(void* param);
+    static void debounceTimerCallback(void* param);
+    static void repeatTimerCallback(void* param);
 
     std::vector<Button> mButtons;
     int mActiveButtonIndex;
-
+    QueueHandle_t mEventQueue;
+    esp_timer_handle_t mRepeatTimer;
+    uint32_t mRepeatIntervalMs;
 };
 }   // namespace hla
 
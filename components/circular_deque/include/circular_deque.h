@@ -1,189 +1,140 @@
 #ifndef circular_deque_h
 #define circular_deque_h
 
+#include <cstddef>
 #include <optional>
+#include <utility>
 
 namespace hla {
+/**
+ * @brief Circular double-ended container
+ *
+ * Elements are kept in a single contiguous ring buffer which grows by doubling
+ * its capacity. Compared to a linked list there is no per-element overhead
+ * (one byte per element for uint8_t) and elements are accessible by index in
+ * constant time.
+ */
 template <typename T> class CircularDeque {
-  private:
-    struct Node {
-        T value;
-        Node* next;
-        Node* prev;
-        Node(T value) : value(value), next(nullptr), prev(nullptr) {}
-    };
-
   public:
     class Cursor {
       public:
         /**
          * @brief Constructor
          *
-         * @param[in] start Pointer to a node
+         * @param[in] deque Pointer to the container, nullptr for an invalid
+         * cursor
+         * @param[in] index Logical index of the element in the container
          */
-        Cursor(Node* start) : mCurrent(start) {}
+        Cursor(const CircularDeque* deque, int index = 0)
+            : mDeque(deque), mIndex(index) {}
 
         /**
          * @brief Return the value that the cursor holds
          * @return the value
          */
-        T& value() { return mCurrent->value; }
+        const T& value() const { return mDeque->at(mIndex); }
+
+        /**
+         * @brief Return the index of the element the cursor points to
+         * @return the index
+         */
+        int index() const { return mIndex; }
 
         /**
          * @brief Move cursor to the next element
          */
         Cursor next() const {
-            return mCurrent ? Cursor(mCurrent->next) : Cursor(nullptr);
+            if (!isValid()) {
+                return Cursor(nullptr);
+            }
+            int index = mIndex + 1 < mDeque->mSize ? mIndex + 1 : 0;
+            return Cursor(mDeque, index);
         }
 
         /**
          * @brief Move cursor to the previous element
          */
         Cursor prev() const {
-            return mCurrent ? Cursor(mCurrent->prev) : Cursor(nullptr);
+            if (!isValid()) {
+                return Cursor(nullptr);
+            }
+            int index = mIndex > 0 ? mIndex - 1 : mDeque->mSize - 1;
+            return Cursor(mDeque, index);
         }
 
         /**
          * @brief Check if the cursor is valud, not null
          * @return True if valid, false if invalid
          */
-        bool isValid() const { return mCurrent != nullptr; }
+        bool isValid() const {
+            return mDeque != nullptr && mIndex >= 0 && mIndex < mDeque->mSize;
+        }
 
         /**
          * @brief Reset cursor
          */
-        void reset() { mCurrent = nullptr; }
+        void reset() {
+            mDeque = nullptr;
+            mIndex = 0;
+        }
 
       private:
-        Node* mCurrent;
+        const CircularDeque* mDeque;
+        int mIndex;
     };
 
     /**
      * @brief Constructor
      */
-    CircularDeque() : mHead(nullptr), mTail(nullptr), mSize(0) {}
+    CircularDeque() : mBuffer(nullptr), mCapacity(0), mHead(0), mSize(0) {}
 
     /**
      * @brief Destructor
      */
-    ~CircularDeque() {
-        if (!mHead) {
-            return;
-        }
-        Node* ptr = mHead->next;
-        while (ptr != mHead) {
-            Node* tmp = ptr;
-            ptr = ptr->next;
-            delete tmp;
-        }
-        if (mHead) {
-            delete mHead;
-        }
-    }
+    ~CircularDeque() { delete[] mBuffer; }
 
     /**
      * @brief Copy constructor
      */
-    CircularDeque(const CircularDeque& other) {
-        if (!other.mHead || !other.mTail) {
-            mHead = nullptr;
-            mTail = nullptr;
-            return;
-        }
-        mHead = new Node(other.mHead->value);
-        Node* src = other.mHead->next;
-        Node* dst = mHead;
-        while (src != other.mHead) {
-            Node* tmp = new Node(src->value);
-            dst->next = tmp;
-            tmp->prev = dst;
-            dst = dst->next;
-            src = src->next;
-        }
-        dst->next = mHead;
-        mHead->prev = dst;
-        mTail = mHead->prev;
-        mSize = other.mSize;
+    CircularDeque(const CircularDeque& other)
+        : mBuffer(nullptr), mCapacity(0), mHead(0), mSize(0) {
+        copyFrom(other);
     }
 
     /**
      * @brief Copy assignment operator
      */
     CircularDeque& operator=(const CircularDeque& other) {
-        if (this == other) {
+        if (this == &other) {
             return *this;
         }
-
-        if (mHead) {
-            Node* ptr = mHead->next;
-            while (ptr != mHead) {
-                Node* tmp = ptr;
-                ptr = ptr->next;
-                delete tmp;
-            }
-            if (mHead) {
-                delete mHead;
-                mHead = nullptr;
-            }
-            mTail = nullptr;
-        }
-
-        mHead = new Node(other.mHead->value);
-        Node* src = other.mHead->next;
-        Node* dst = mHead;
-        while (src != other.mHead) {
-            Node* tmp = new Node(src->value);
-            dst->next = tmp;
-            tmp->prev = dst;
-            dst = dst->next;
-            src = src->next;
-        }
-        dst->next = mHead;
-        mHead->prev = dst;
-        mTail = mHead->prev;
-        mSize = other.mSize;
+        empty();
+        copyFrom(other);
         return *this;
     }
 
     /**
-     * @brief Add a new node to the beginning of the container
+     * @brief Add a new element to the beginning of the container
      * @param[in] value Value
      */
     void pushFront(T value) {
-        if (!mHead && !mTail) {
-            mHead = new Node(value);
-            mHead->next = mHead;
-            mHead->prev = mHead;
-            mTail = mHead;
-        } else {
-            Node* tmp = new Node(value);
-            tmp->next = mHead;
-            tmp->prev = mTail;
-            mHead->prev = tmp;
-            mHead = tmp;
-            mTail->next = mHead;
+        if (mSize == mCapacity) {
+            grow(mCapacity ? mCapacity * 2 : kInitialCapacity);
         }
+        mHead = mHead > 0 ? mHead - 1 : mCapacity - 1;
+        mBuffer[mHead] = std::move(value);
         ++mSize;
     }
 
     /**
-     * @brief Add a new node to the end of the container
+     * @brief Add a new element to the end of the container
      * @param[in] value Value
      */
     void pushBack(T value) {
-        if (!mHead && !mTail) {
-            mHead = new Node(value);
-            mHead->next = mHead;
-            mHead->prev = mHead;
-            mTail = mHead;
-        } else {
-            Node* tmp = new Node(value);
-            tmp->next = mHead;
-            tmp->prev = mTail;
-            mTail->next = tmp;
-            mTail = tmp;
-            mHead->prev = mTail;
+        if (mSize == mCapacity) {
+            grow(mCapacity ? mCapacity * 2 : kInitialCapacity);
         }
+        mBuffer[physicalIndex(mSize)] = std::move(value);
         ++mSize;
     }
 
@@ -192,10 +143,10 @@ template <typename T> class CircularDeque {
      * @return Value
      */
     std::optional<T> front() const {
-        if (!mHead) {
+        if (!mSize) {
             return std::nullopt;
         }
-        return mHead->value;
+        return mBuffer[mHead];
     }
 
     /**
@@ -203,51 +154,30 @@ template <typename T> class CircularDeque {
      * @return Value
      */
     std::optional<T> back() const {
-        if (!mTail) {
+        if (!mSize) {
             return std::nullopt;
         }
-        return mTail->value;
+        return mBuffer[physicalIndex(mSize - 1)];
     }
 
     /**
-     * @brief Remove a node from the begining of the container
+     * @brief Remove an element from the begining of the container
      */
     void popFront() {
-        if (!mHead || !mTail) {
-            return;
-        }
-        if (mHead == mHead->next && mHead == mHead->prev) {
-            delete mHead;
-            mHead = nullptr;
-            mTail = nullptr;
+        if (!mSize) {
             return;
         }
-        Node* tmp = mHead;
-        mHead = mHead->next;
-        mHead->prev = mTail;
-        mTail->next = mHead;
-        delete tmp;
+        mHead = physicalIndex(1);
         --mSize;
     }
 
     /**
-     * @brief Remove a node from the end of the container
+     * @brief Remove an element from the end of the container
      */
     void popBack() {
-        if (!mHead || !mTail) {
+        if (!mSize) {
             return;
         }
-        if (mHead == mHead->next && mHead == mHead->prev) {
-            delete mHead;
-            mHead = nullptr;
-            mTail = nullptr;
-            return;
-        }
-        Node* tmp = mTail;
-        mTail = mTail->prev;
-        mTail->next = mHead;
-        mHead->prev = mTail;
-        delete tmp;
         --mSize;
     }
 
@@ -255,13 +185,27 @@ template <typename T> class CircularDeque {
      * @brief Get a cursor that points to the beginning of the container
      * @return cursor
      */
-    Cursor frontCursor() const { return Cursor(mHead); }
+    Cursor frontCursor() const {
+        return mSize ? Cursor(this, 0) : Cursor(nullptr);
+    }
 
     /**
      * @brief Get a cursor that points to the end of the container
      * @return cursor
      */
-    Cursor backCursor() const { return Cursor(mTail); }
+    Cursor backCursor() const {
+        return mSize ? Cursor(this, mSize - 1) : Cursor(nullptr);
+    }
+
+    /**
+     * @brief Get a cursor that points to an element at a given index
+     * @param[in] index Index of the element
+     * @return cursor, invalid if the index is out of range
+     */
+    Cursor cursorAt(int index) const {
+        return index >= 0 && index < mSize ? Cursor(this, index)
+                                           : Cursor(nullptr);
+    }
 
     /**
      * @brief Get size of the container
@@ -270,30 +214,67 @@ template <typename T> class CircularDeque {
     int length() const { return mSize; }
 
     /**
-     * @brief Clear the container
+     * @brief Preallocate storage for at least a given number of elements
+     *
+     * Use it when the final size is known upfront to end up with exactly one
+     * allocation.
+     *
+     * @param[in] capacity Number of elements
+     */
+    void reserve(int capacity) {
+        if (capacity > mCapacity) {
+            grow(capacity);
+        }
+    }
+
+    /**
+     * @brief Clear the container and release its storage
      */
     void empty() {
-        if (!mHead) {
-            return;
+        delete[] mBuffer;
+        mBuffer = nullptr;
+        mCapacity = 0;
+        mHead = 0;
+        mSize = 0;
+    }
+
+  private:
+    static constexpr int kInitialCapacity = 16;
+
+    int physicalIndex(int index) const {
+        int i = mHead + index;
+        return i >= mCapacity ? i - mCapacity : i;
+    }
+
+    T& at(int index) { return mBuffer[physicalIndex(index)]; }
+    const T& at(int index) const { return mBuffer[physicalIndex(index)]; }
+
+    void grow(int capacity) {
+        T* buffer = new T[capacity];
+        for (int i = 0; i < mSize; ++i) {
+            buffer[i] = std::move(at(i));
         }
-        Node* ptr = mHead->next;
-        while (ptr != mHead) {
-            Node* tmp = ptr;
-            ptr = ptr->next;
-            delete tmp;
+        delete[] mBuffer;
+        mBuffer = buffer;
+        mCapacity = capacity;
+        mHead = 0;
+    }
+
+    void copyFrom(const CircularDeque& other) {
+        if (!other.mSize) {
+            return;
         }
-        if (mHead) {
-            delete mHead;
+        grow(other.mSize);
+        for (int i = 0; i < other.mSize; ++i) {
+            mBuffer[i] = other.at(i);
         }
-        mHead = nullptr;
-        mTail = nullptr;
-        mSize = 0;
+        mSize = other.mSize;
     }
 
-  private:
-    Node* mHead;
-    Node* mTail;
+    T* mBuffer;
+    int mCapacity;
+    int mHead;
     int mSize;
 };
 }   // namespace hla
-#endif   // circular_deque_h
\ No newline at end of file
+#endif   // circular_deque_h
@@ -28,12 +28,33 @@ class Sh1106 {
     /**
      * @brief Send a buffer to display.
      *
+     * Only the columns which differ from the previously sent frame are
+     * transmitted.
+     *
      * @param[in] buffer Pointer to a buffer containing data meant to be shown
      * on the display
-     * @param[in] len Length of the buffer in bytes
      */
     void display(const uint8_t* buffer);
 
+    /**
+     * @brief Force the next call to display() to send the whole frame
+     */
+    void invalidate();
+
+    /**
+     * @brief Return number of display data bytes sent for the last frame
+     *
+     * @return Number of bytes, without command and control bytes
+     */
+    uint16_t getBytesSent() const;
+
+    /**
+     * @brief Return number of I2C transactions since initialization
+     *
+     * @return Number of transactions
+     */
+    uint32_t getTransactionCount() const;
+
     /**
      * @brief Return screen width
      *
@@ -57,13 +78,22 @@ class Sh1106 {
     void sendCommand(uint8_t cmd);
 
     /**
-     * @brief Send multiple commands to display via I2C
+     * @brief Send multiple commands to display in a single I2C transaction
      *
      * @param[in] cmds Buffer containing commands
      * @param[in] len Size of the buffer
      */
     void sendCommands(const uint8_t* cmds, uint16_t len);
 
+    /**
+     * @brief Transmit a buffer to display and count the transaction
+     *
+     * @param[in] buf Buffer starting with a control byte
+     * @param[in] len Size of the buffer
+     * @return ESP_OK if the display acknowledged the transaction
+     */
+    esp_err_t transmit(const uint8_t* buf, size_t len);
+
     /**
      * @brief Initialize I2C master
      *
@@ -73,8 +103,14 @@ class Sh1106 {
      */
     void i2cMasterInit(i2c_port_num_t i2cPort, gpio_num_t sda, gpio_num_t scl);
 
+    static constexpr uint16_t kBufferSize = 128 * 64 / 8;
+
     i2c_master_bus_handle_t mI2cBusHandle;
     i2c_master_dev_handle_t mI2cDevHandle;
+    uint8_t mShadow[kBufferSize];   // last frame sent to the display
+    bool mShadowValid = false;
+    uint16_t mBytesSent = 0;
+    uint32_t mTransactionCount = 0;
 };
 
 #endif   // sh1106_h
\ No newline at end of file
@@ -2,8 +2,10 @@
 
 #include <cstring>
 
+#include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 
+static const char* kTag = "sh1106";
 static constexpr uint8_t i2cTicksToWait = 100;
 
 // SSD1306 commands
@@ -39,6 +41,10 @@ static constexpr uint8_t kSetVcomDesel = 0xDB;
 static constexpr uint8_t kWidth = 128;
 static constexpr uint8_t kHeight = 64;
 static constexpr uint8_t kPageHeight = 8;
+// SH1106 has 132 columns of RAM, the 128 pixel wide panel starts at column 2
+static constexpr uint8_t kColumnOffset = 2;
+// Maximum number of commands sent in a single I2C transaction
+static constexpr uint16_t kMaxCommands = 32;
 
 void Sh1106::i2cMasterInit(i2c_port_num_t i2cPort, gpio_num_t sdaPin,
                            gpio_num_t sclPin) {
@@ -87,39 +93,84 @@ void Sh1106::initialize(i2c_port_num_t i2cPort, gpio_num_t sdaPin,
         kSetDisp | 0x01        // turn display on
     };
     sendCommands(cmds, sizeof(cmds));
+    invalidate();
 }
 
 void Sh1106::display(const uint8_t* buffer) {
+    mBytesSent = 0;
+    bool sent = true;
     for (uint8_t page = 0; page < kHeight / kPageHeight; page++) {
-        uint8_t cmds[] = {
-            static_cast<uint8_t>(0xB0 + page),   // Set page address (B0 to B7)
-            0x02,   // Set lower column address (start at 2)
-            0x10    // Set higher column address
-        };
-        sendCommands(cmds, sizeof(cmds));
-
-        uint8_t temp_buf[kWidth + 1];
-        temp_buf[0] = 0x40;
-        memcpy(temp_buf + 1, &buffer[page * kWidth], kWidth);
-        i2c_master_transmit(mI2cDevHandle, temp_buf, kWidth + 1,
-                            i2cTicksToWait);
+        const uint8_t* data = &buffer[page * kWidth];
+        uint8_t* shadow = &mShadow[page * kWidth];
+        // find the range of changed columns
+        uint8_t first = 0;
+        uint8_t last = kWidth - 1;
+        if (mShadowValid) {
+            while (first < kWidth && data[first] == shadow[first]) {
+                ++first;
+            }
+            if (first == kWidth) {
+                continue;   // nothing changed on this page
+            }
+            while (data[last] == shadow[last]) {
+                --last;
+            }
+        }
+        uint8_t len = last - first + 1;
+        uint8_t column = first + kColumnOffset;
+        // Page address setup and display data are sent in one transaction.
+        // Each command is preceded by a control byte with Co = 1, D/C = 0,
+        // the last control byte (Co = 0, D/C = 1) marks the rest as data.
+        uint8_t temp_buf[kWidth + 7] = {
+            0x80, static_cast<uint8_t>(0xB0 + page),   // Set page address
+            0x80, static_cast<uint8_t>(column & 0x0F),         // lower column
+            0x80, static_cast<uint8_t>(0x10 | (column >> 4)),  // higher column
+            0x40};
+        memcpy(temp_buf + 7, &data[first], len);
+        if (transmit(temp_buf, len + 7) != ESP_OK) {
+            // the content of the page is unknown now
+            sent = false;
+            continue;
+        }
+        memcpy(&shadow[first], &data[first], len);
+        mBytesSent += len;
     }
+    // after a failed page the next frame is sent as a whole
+    mShadowValid = sent;
 }
 
+void Sh1106::invalidate() { mShadowValid = false; }
+
+uint16_t Sh1106::getBytesSent() const { return mBytesSent; }
+
 uint16_t Sh1106::getWidth() const { return kWidth; }
 
 uint16_t Sh1106::getHeight() const { return kHeight; }
 
-void Sh1106::sendCommand(uint8_t cmd) {
+uint32_t Sh1106::getTransactionCount() const { return mTransactionCount; }
+
+void Sh1106::sendCommand(uint8_t cmd) { sendCommands(&cmd, 1); }
+
+void Sh1106::sendCommands(const uint8_t* cmds, uint16_t len) {
     // I2C write process expects a control byte followed by data
-    // this "data" can be a command or data to follow up a command
-    // Co = 1, D/C = 0 => the driver expects a command
-    uint8_t buf[2] = {0x80, cmd};
-    i2c_master_transmit(mI2cDevHandle, buf, 2, i2cTicksToWait);
+    // Co = 0, D/C = 0 => all following bytes are commands
+    uint8_t buf[kMaxCommands + 1];
+    buf[0] = 0x00;
+    while (len > 0) {
+        uint16_t count = len < kMaxCommands ? len : kMaxCommands;
+        memcpy(buf + 1, cmds, count);
+        transmit(buf, count + 1);
+        cmds += count;
+        len -= count;
+    }
 }
 
-void Sh1106::sendCommands(const uint8_t* cmds, uint16_t len) {
-    for (int i = 0; i < len; ++i) {
-        sendCommand(cmds[i]);
+esp_err_t Sh1106::transmit(const uint8_t* buf, size_t len) {
+    ++mTransactionCount;
+    esp_err_t err =
+        i2c_master_transmit(mI2cDevHandle, buf, len, i2cTicksToWait);
+    if (err != ESP_OK) {
+        ESP_LOGE(kTag, "I2C transmit failed (%s)", esp_err_to_name(err));
     }
+    return err;
 }
\ No newline at end of file
@@ -19,9 +19,10 @@ class WifiInfo {
 }
 
 class LiftPlan {
-    constructor(name, isDisabled = false) {
+    constructor(name, isDisabled = false, onRowClick = null) {
         this.name = name;
         this.isDisabled = isDisabled;
+        this.onRowClick = onRowClick;
     }
 
     #createCell(lifted) {
@@ -45,6 +46,9 @@ class LiftPlan {
         for (let j = 0; j < 8; j++) {
             tr.appendChild(this.#createCell(binaryStr[7 - j] === '1', this.isDisabled));
         }
+        if (this.onRowClick) {
+            tr.onclick = () => this.onRowClick(tr.rowIndex);
+        }
         let liftplanTable = document.getElementById(this.name);
         liftplanTable.appendChild(tr);
     }
@@ -108,7 +112,6 @@ class LiftPlan {
 }
 
 var liftplanEditableTable = new LiftPlan("liftplanEditableTable");
-var loomIntervalId = 0;
 var loomInfo = null;
 
 function openTab(id, tabName) {
@@ -144,6 +147,7 @@ window.addEventListener('load', function () {
     setEqualTabButtonWidth("mainTab");
     setEqualTabButtonWidth("liftplanTab");
     openMainTab("mainTab", "Dashboard");
+    openLoomEvents();
 });
 
 function openMainTab(id, tabName) {
@@ -237,7 +241,8 @@ function getLiftplan(name, dest) {
             return response.json();
         })
         .then(data => {
-            let liftplanTable = new LiftPlan(dest, true);
+            let onRowClick = dest == "liftplanActiveTable" ? seekLoom : null;
+            let liftplanTable = new LiftPlan(dest, true, onRowClick);
             liftplanTable.populateFromArray(data);
         })
         .catch(error => {
@@ -275,7 +280,7 @@ function deleteLiftplan() {
         method: 'DELETE'
     }).then(res => {
         if (res.ok) handleLiftplanPreview();
-        else console.log("Failed to send liftplan");
+        else res.text().then(text => console.log("Failed to delete liftplan: " + text));
     });
 }
 
@@ -393,10 +398,6 @@ function handleLoomState(state) {
         document.getElementById("continueButton").style.display = "none";
         document.getElementById("stopButton").style.display = "none";
         document.getElementById("selectLiftplan").disabled = false;
-        if (loomIntervalId != 0) {
-            clearInterval(loomIntervalId);
-            loomIntervalId = 0;
-        }
         enableTab("mainTab", "Liftplan");
         enableTab("mainTab", "Settings");
     } else if (state == "running") {
@@ -405,9 +406,6 @@ function handleLoomState(state) {
         document.getElementById("continueButton").style.display = "none";
         document.getElementById("stopButton").style.display = "block";
         document.getElementById("selectLiftplan").disabled = true;
-        if (loomIntervalId == 0) {
-            loomIntervalId = setInterval(getLoomLiftplanIndex, 1000);
-        }
         disableTab("mainTab", "Liftplan");
         disableTab("mainTab", "Settings");
     } else if (state == "paused") {
@@ -416,11 +414,14 @@ function handleLoomState(state) {
         document.getElementById("continueButton").style.display = "block";
         document.getElementById("stopButton").style.display = "block";
         document.getElementById("selectLiftplan").disabled = true;
-        if (loomIntervalId == 0) {
-            loomIntervalId = setInterval(getLoomLiftplanIndex, 1000);
-        }
         disableTab("mainTab", "Liftplan");
         disableTab("mainTab", "Settings");
+    } else if (state == "pausing" || state == "stopping") {
+        document.getElementById("startButton").style.display = "none";
+        document.getElementById("pauseButton").style.display = "none";
+        document.getElementById("continueButton").style.display = "none";
+        document.getElementById("stopButton").style.display = state == "pausing" ? "block" : "none";
+        document.getElementById("selectLiftplan").disabled = true;
     }
 }
 
@@ -434,15 +435,46 @@ function getLoomState() {
         })
         .then(data => {
             console.log("Loom state =  " + JSON.stringify(data));
-            loomInfo = data;
-            handleLoomState(loomInfo.loom_state);
-
+            updateLoomInfo(data);
         })
         .catch(error => {
             console.error('There was a problem with the getting loom state:', error);
         });
 }
 
+function updateLoomInfo(data) {
+    const wasStopping = loomInfo && loomInfo.loom_state == "stopping";
+    loomInfo = data;
+    handleLoomState(loomInfo.loom_state);
+    if (loomInfo.shafts_error) {
+        document.getElementById("statusLabel").innerHTML += " - SHAFTS NOT IN POSITION";
+    }
+    if (wasStopping && loomInfo.loom_state == "idle") {
+        // reset the liftplan table
+        updateLiftplanSelect();
+    }
+}
+
+function openLoomEvents() {
+    // the loom pushes its status on every change, the browser reconnects by
+    // itself when the connection is lost
+    const loomEvents = new EventSource('/api/v1/loom/events');
+    loomEvents.onmessage = function (event) {
+        const data = JSON.parse(event.data);
+        if (data.loom_state === undefined) {
+            return;
+        }
+        updateLoomInfo(data);
+        if (data.index !== undefined && (data.loom_state == "running" || data.loom_state == "paused")) {
+            liftplanActiveTable = new LiftPlan("liftplanActiveTable", true);
+            liftplanActiveTable.highlightRow(data.index);
+        }
+    };
+    loomEvents.onerror = function () {
+        console.error('Loom event stream is disconnected');
+    };
+}
+
 function startLoom() {
     const requestOptions = {
         method: 'POST',
@@ -474,7 +506,6 @@ function pauseLoom() {
         .then(response => response.json())
         .then(data => {
             console.log("Pause loom response: " + JSON.stringify(data));
-            handleLoomState("paused");
         });
 }
 
@@ -501,27 +532,28 @@ function stopLoom() {
         .then(data => {
             console.log("Stop loom response: " + JSON.stringify(data));
             if (data.status == true) {
-                handleLoomState("idle");
-                // reset the liftplan table
-                updateLiftplanSelect();
+                // the shafts are lowered in the background, the event stream
+                // reports when the loom is idle
+                if (loomInfo) {
+                    loomInfo.loom_state = "stopping";
+                }
             }
         });
 }
 
-function getLoomLiftplanIndex() {
-    fetch('/api/v1/loom/liftplan_index')
-        .then(response => {
-            if (!response.ok) {
-                throw new Error('Network response was not ok');
-            }
-            return response.json();
+function seekLoom(index) {
+    const requestOptions = {
+        method: 'POST',
+        headers: {
+            'Content-Type': 'application/json'
+        },
+        body: JSON.stringify({
+            'index': index
         })
+    };
+    fetch("/api/v1/loom/seek", requestOptions)
+        .then(response => response.json())
         .then(data => {
-            console.log("Loom liftplan index =  " + JSON.stringify(data));
-            liftplanActiveTable = new LiftPlan("liftplanActiveTable", true);
-            liftplanActiveTable.highlightRow(data.index);
-        })
-        .catch(error => {
-            console.error('There was a problem with the getting loom liftplan index:', error);
+            console.log("Seek loom response: " + JSON.stringify(data));
         });
 }
\ No newline at end of file
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <inttypes.h>
@@ -9,12 +11,30 @@
 #include "config_store.h"
 
 using hla::ConfigStore;
+using hla::Liftplan;
+using hla::LiftplanParser;
+using hla::LiftplanWriter;
 using hla::LoomInfo;
 using hla::WifiInfo;
 
 static constexpr const char* kWifiInfoFile = "/littlefs/config/wifi_info.json";
 static constexpr const char* kLiftplanDir = "/littlefs/liftplans";
 static constexpr const char* kLoomInfoFile = "/littlefs/saved_state.json";
+static constexpr const char* kLiftplanBinDir = "/littlefs/liftplans_bin";
+static constexpr const char* kUploadFile = "/littlefs/upload.json.tmp";
+static constexpr const char* kUploadBinFile = "/littlefs/upload.bin.tmp";
+static constexpr size_t kReadChunkSize = 256;
+static constexpr size_t kSendChunkSize = 512;
+static constexpr size_t kPickChunkSize = 64;
+static std::filesystem::path binaryLiftplanPath(const std::string& fileName) {
+    return std::filesystem::path(kLiftplanBinDir) /
+           std::filesystem::path(fileName + ".bin");
+}
+
+static bool createDirectory(const char* path) {
+    return std::filesystem::exists(path) ||
+           std::filesystem::create_directory(path);
+}
 
 std::optional<WifiInfo> ConfigStore::loadWifiInfo() {
     // check if file exists on kWifiInfoFile path
@@ -66,23 +86,107 @@ std::vector<std::string> ConfigStore::listLiftplanFiles() {
     return result;
 }
 
-std::optional<std::string>
-ConfigStore::loadLiftplan(const std::string& fileName) {
+std::optional<size_t>
+ConfigStore::getLiftplanSize(const std::string& fileName) {
     std::filesystem::path liftplanFilePath =
         std::filesystem::path(kLiftplanDir) / std::filesystem::path(fileName);
-    // check if file exists on kWifiInfoFile path
-    if (!std::filesystem::exists(liftplanFilePath)) {
+    std::error_code error;
+    auto size = std::filesystem::file_size(liftplanFilePath, error);
+    if (error) {
         return std::nullopt;
     }
-    // read JSON file
-    std::ifstream liftplanFile(liftplanFilePath);
-    std::stringstream buffer;
-    buffer << liftplanFile.rdbuf();
-    return buffer.str();
+    return size;
+}
+
+bool ConfigStore::loadLiftplan(
+    const std::string& fileName, size_t offset, size_t length,
+    const std::function<bool(const char* data, size_t len)>& write) {
+    std::filesystem::path liftplanFilePath =
+        std::filesystem::path(kLiftplanDir) / std::filesystem::path(fileName);
+    std::ifstream liftplanFile(liftplanFilePath, std::ios::binary);
+    if (!liftplanFile.is_open() || !liftplanFile.seekg(offset)) {
+        return false;
+    }
+    char chunk[kSendChunkSize];
+    while (length > 0) {
+        size_t len = std::min(length, sizeof(chunk));
+        if (!liftplanFile.read(chunk, len) || !write(chunk, len)) {
+            return false;
+        }
+        length -= len;
+    }
+    return true;
+}
+
+bool ConfigStore::loadLiftplan(const std::string& fileName,
+                               LiftplanParser& parser) {
+    std::filesystem::path liftplanFilePath =
+        std::filesystem::path(kLiftplanDir) / std::filesystem::path(fileName);
+    std::ifstream liftplanFile(liftplanFilePath, std::ios::binary);
+    if (!liftplanFile.is_open()) {
+        return false;
+    }
+    // feed the parser chunk by chunk
+    char chunk[kReadChunkSize];
+    while (liftplanFile.read(chunk, sizeof(chunk)) ||
+           liftplanFile.gcount() > 0) {
+        if (!parser.feed(chunk, liftplanFile.gcount())) {
+            return false;
+        }
+    }
+    return parser.isComplete();
+}
+
+bool ConfigStore::openLiftplan(const std::string& fileName,
+                               Liftplan& liftplan, bool verify) {
+    const std::string binaryPath = binaryLiftplanPath(fileName);
+    if (liftplan.open(binaryPath, verify)) {
+        return true;
+    }
+    // fall back to the JSON file and recreate the binary copy
+    LiftplanWriter writer;
+    if (!createDirectory(kLiftplanBinDir) || !writer.open(binaryPath)) {
+        return false;
+    }
+    LiftplanParser parser([&writer](uint8_t pick) { writer.write(pick); });
+    bool result = loadLiftplan(fileName, parser);
+    if (!writer.close() || !result) {
+        remove(binaryPath.c_str());
+        return false;
+    }
+    return liftplan.open(binaryPath);
 }
 
-bool ConfigStore::saveLiftPlan(const std::string& fileName,
-                               const std::string& data) {
+std::optional<unsigned int> ConfigStore::loadLiftplanPicks(
+    const std::string& fileName, unsigned int offset, unsigned int limit,
+    const std::function<bool(const uint8_t* picks, size_t count)>& write) {
+    // the binary copy is only recreated by the loom task, see openLiftplan()
+    Liftplan liftplan;
+    if (!liftplan.open(binaryLiftplanPath(fileName), false)) {
+        return std::nullopt;
+    }
+    unsigned int length = liftplan.length();
+    unsigned int end = offset;
+    if (offset < length) {
+        end += std::min(limit, length - offset);
+    }
+    uint8_t picks[kPickChunkSize];
+    for (unsigned int index = offset; index < end;) {
+        size_t count = std::min<size_t>(end - index, sizeof(picks));
+        for (size_t i = 0; i < count; ++i) {
+            picks[i] = liftplan.at(index + i);
+        }
+        if (!write(picks, count)) {
+            return std::nullopt;
+        }
+        index += count;
+    }
+    return length;
+}
+
+bool ConfigStore::saveLiftPlan(
+    const std::string& fileName,
+    const std::function<int(char* buffer, size_t size)>& read) {
     std::filesystem::path liftplanFilePath =
         std::filesystem::path(kLiftplanDir) / std::filesystem::path(fileName);
     // check if file exists on kWifiInfoFile path
@@ -90,20 +194,54 @@ bool ConfigStore::saveLiftPlan(const std::string& fileName,
         return false;
     }
 
-    if (!std::filesystem::exists(kLiftplanDir)) {
-        if (!std::filesystem::create_directory(kLiftplanDir)) {
-            return false;
+    if (!createDirectory(kLiftplanDir) || !createDirectory(kLiftplanBinDir)) {
+        return false;
+    }
+
+    // validate the liftplan while converting it to the binary format
+    std::ofstream liftplanFile(kUploadFile, std::ios::binary);
+    LiftplanWriter writer;
+    if (!liftplanFile.is_open() || !writer.open(kUploadBinFile)) {
+        liftplanFile.close();
+        remove(kUploadFile);
+        remove(kUploadBinFile);
+        return false;
+    }
+    LiftplanParser parser([&writer](uint8_t pick) { writer.write(pick); });
+    char chunk[kReadChunkSize];
+    bool result = true;
+    while (result) {
+        int len = read(chunk, sizeof(chunk));
+        if (len == 0) {
+            break;
         }
+        result = len > 0 && parser.feed(chunk, len) &&
+                 liftplanFile.write(chunk, len);
     }
+    result = result && parser.isComplete();
+    result = writer.close() && result;
+    liftplanFile.close();
+    result = result && !liftplanFile.fail();
 
-    std::ofstream liftplanFile(liftplanFilePath);
-    liftplanFile << data;
-    return true;
+    // the JSON file is renamed last, the liftplan is listed only once both
+    // files are in place
+    const std::string binaryPath = binaryLiftplanPath(fileName);
+    if (result && !std::filesystem::exists(liftplanFilePath) &&
+        rename(kUploadBinFile, binaryPath.c_str()) == 0) {
+        if (rename(kUploadFile, liftplanFilePath.c_str()) == 0) {
+            return true;
+        }
+        remove(binaryPath.c_str());
+    }
+    remove(kUploadFile);
+    remove(kUploadBinFile);
+    return false;
 }
 
 bool ConfigStore::deleteLiftPlan(const std::string& fileName) {
     const std::filesystem::path liftplanFilePath =
         std::filesystem::path(kLiftplanDir) / std::filesystem::path(fileName);
+    remove(binaryLiftplanPath(fileName).c_str());
     return remove(liftplanFilePath.c_str()) == 0;
 }
 
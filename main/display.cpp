@@ -0,0 +1,58 @@
+#include "display.h"
+
+#include <utility>
+
+using hla::Display;
+
+Display::Display(Sh1106& oled)
+    : mOled(oled), mFrameSize(oled.getWidth() * oled.getHeight() / 8),
+      mHasPendingFrame(false), mCoalescedCount(0), mMutex(nullptr),
+      mTask(nullptr) {
+    mPendingFrame = new uint8_t[mFrameSize];
+    mFrame = new uint8_t[mFrameSize];
+}
+
+Display::~Display() {
+    delete[] mPendingFrame;
+    delete[] mFrame;
+}
+
+void Display::initialize() {
+    mMutex = xSemaphoreCreateMutex();
+    // lower priority than the button and uart tasks, so a slow I2C transfer
+    // never delays moving the shafts
+    xTaskCreate(taskLoop, "display_task", 3072, this, 5, &mTask);
+}
+
+void Display::show(const Screen& screen) {
+    xSemaphoreTake(mMutex, portMAX_DELAY);
+    if (mHasPendingFrame) {
+        ++mCoalescedCount;
+    }
+    screen.copyFrontBuffer(mPendingFrame);
+    mHasPendingFrame = true;
+    xSemaphoreGive(mMutex);
+    xTaskNotifyGive(mTask);
+}
+
+uint32_t Display::getCoalescedCount() const { return mCoalescedCount; }
+
+void Display::loop() {
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        xSemaphoreTake(mMutex, portMAX_DELAY);
+        if (!mHasPendingFrame) {
+            xSemaphoreGive(mMutex);
+            continue;
+        }
+        std::swap(mPendingFrame, mFrame);
+        mHasPendingFrame = false;
+        xSemaphoreGive(mMutex);
+        mOled.display(mFrame);
+    }
+}
+
+void Display::taskLoop(void* param) {
+    Display* self = static_cast<Display*>(param);
+    self->loop();
+}
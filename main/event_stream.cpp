@@ -0,0 +1,142 @@
+#include "event_stream.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "esp_log.h"
+
+using hla::EventStream;
+
+static const char* kTag = "event_stream";
+
+EventStream::EventStream()
+    : mClients(), mLatest(), mHandle(nullptr), mSendQueued(false) {
+    // events may be published even if the server failed to start
+    mMutex = xSemaphoreCreateMutex();
+}
+
+esp_err_t EventStream::open(httpd_req_t* req) {
+    xSemaphoreTake(mMutex, portMAX_DELAY);
+    Client* client = nullptr;
+    for (auto& candidate : mClients) {
+        if (!candidate.active) {
+            client = &candidate;
+            break;
+        }
+    }
+    if (!client) {
+        xSemaphoreGive(mMutex);
+        ESP_LOGW(kTag, "Too many clients");
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR,
+                                   "Too many event stream clients");
+    }
+    client->stream = this;
+    client->active = true;
+    client->overflow = false;
+    client->handle = req->handle;
+    client->fd = httpd_req_to_sockfd(req);
+    client->head = 0;
+    client->count = 0;
+    mHandle = req->handle;
+    char first[kMaxEventSize + 32];
+    int len = snprintf(first, sizeof(first), "retry: 3000\n\ndata: %s\n\n",
+                       mLatest[0] ? mLatest : "{}");
+    xSemaphoreGive(mMutex);
+
+    // the client is removed when httpd closes the session
+    req->sess_ctx = client;
+    req->free_ctx = onClose;
+    httpd_resp_set_type(req, "text/event-stream");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    // the first chunk sends the headers, the response is never finished and
+    // the following chunks are written straight to the socket
+    if (httpd_resp_send_chunk(req, first, len) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    ESP_LOGI(kTag, "Client %d connected", client->fd);
+    return ESP_OK;
+}
+
+void EventStream::publish(const char* data) {
+    xSemaphoreTake(mMutex, portMAX_DELAY);
+    if (strncmp(mLatest, data, sizeof(mLatest)) == 0) {
+        xSemaphoreGive(mMutex);
+        return;
+    }
+    snprintf(mLatest, sizeof(mLatest), "%s", data);
+    bool pending = false;
+    for (auto& client : mClients) {
+        if (!client.active || client.overflow) {
+            continue;
+        }
+        if (client.count == kQueueSize) {
+            client.overflow = true;
+        } else {
+            int tail = (client.head + client.count) % kQueueSize;
+            snprintf(client.events[tail], kMaxEventSize, "%s", data);
+            ++client.count;
+        }
+        pending = true;
+    }
+    httpd_handle_t handle = mHandle;
+    xSemaphoreGive(mMutex);
+    if (pending && !mSendQueued.exchange(true)) {
+        if (httpd_queue_work(handle, sendWork, this) != ESP_OK) {
+            mSendQueued = false;
+        }
+    }
+}
+
+void EventStream::send() {
+    mSendQueued = false;
+    for (auto& client : mClients) {
+        char chunk[kMaxEventSize + 32];
+        while (true) {
+            xSemaphoreTake(mMutex, portMAX_DELAY);
+            if (!client.active) {
+                xSemaphoreGive(mMutex);
+                break;
+            }
+            if (client.overflow) {
+                client.overflow = false;
+                client.count = 0;
+                int fd = client.fd;
+                xSemaphoreGive(mMutex);
+                ESP_LOGW(kTag, "Client %d too slow, closing", fd);
+                httpd_sess_trigger_close(client.handle, fd);
+                break;
+            }
+            if (client.count == 0) {
+                xSemaphoreGive(mMutex);
+                break;
+            }
+            // frame the event as a chunk of the chunked response
+            int dataLen = strlen(client.events[client.head]) + 8;
+            int len = snprintf(chunk, sizeof(chunk), "%x\r\ndata: %s\n\n\r\n",
+                               dataLen, client.events[client.head]);
+            client.head = (client.head + 1) % kQueueSize;
+            --client.count;
+            httpd_handle_t handle = client.handle;
+            int fd = client.fd;
+            xSemaphoreGive(mMutex);
+            if (httpd_socket_send(handle, fd, chunk, len, 0) < 0) {
+                ESP_LOGW(kTag, "Client %d send failed, closing", fd);
+                httpd_sess_trigger_close(handle, fd);
+                break;
+            }
+        }
+    }
+}
+
+void EventStream::sendWork(void* arg) {
+    static_cast<EventStream*>(arg)->send();
+}
+
+void EventStream::onClose(void* ctx) {
+    Client* client = static_cast<Client*>(ctx);
+    EventStream* self = client->stream;
+    xSemaphoreTake(self->mMutex, portMAX_DELAY);
+    ESP_LOGI(kTag, "Client %d disconnected", client->fd);
+    client->active = false;
+    xSemaphoreGive(self->mMutex);
+}
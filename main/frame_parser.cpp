@@ -0,0 +1,80 @@
+#include "frame_parser.h"
+
+#include <cstring>
+
+using hla::FrameParser;
+
+struct Crc8Table {
+    uint8_t crc[256];
+};
+
+static constexpr Crc8Table makeCrc8Table() {
+    Crc8Table table{};
+    for (int i = 0; i < 256; ++i) {
+        uint8_t crc = i;
+        for (int j = 0; j < 8; ++j) {
+            crc = crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+        table.crc[i] = crc;
+    }
+    return table;
+}
+
+static constexpr Crc8Table kCrc8 = makeCrc8Table();
+
+FrameParser::FrameParser(const std::function<void(const Frame&)>& onFrame)
+    : mOnFrame(onFrame), mLength(0), mCrcErrorCount(0), mSkippedByteCount(0) {}
+
+void FrameParser::reset() { mLength = 0; }
+
+void FrameParser::feed(const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        if (mLength == 0 && data[i] != kStartOfFrame) {
+            ++mSkippedByteCount;
+            continue;
+        }
+        mBuffer[mLength++] = data[i];
+        if (mLength < kFrameSize) {
+            continue;
+        }
+        if (crc8(mBuffer + 1, 3) == mBuffer[4]) {
+            mLength = 0;
+            mOnFrame({mBuffer[1], mBuffer[2], mBuffer[3]});
+        } else {
+            ++mCrcErrorCount;
+            resync();
+        }
+    }
+}
+
+uint32_t FrameParser::getCrcErrorCount() const { return mCrcErrorCount; }
+
+uint32_t FrameParser::getSkippedByteCount() const { return mSkippedByteCount; }
+
+void FrameParser::encode(const Frame& frame, uint8_t* buf) {
+    buf[0] = kStartOfFrame;
+    buf[1] = frame.cmd;
+    buf[2] = frame.seq;
+    buf[3] = frame.data;
+    buf[4] = crc8(buf + 1, 3);
+}
+
+uint8_t FrameParser::crc8(const uint8_t* data, size_t len) {
+    uint8_t crc = 0x00;   // Initial value
+    for (size_t i = 0; i < len; ++i) {
+        crc = kCrc8.crc[crc ^ data[i]];
+    }
+    return crc;
+}
+
+void FrameParser::resync() {
+    // the marker of the rejected frame was wrong, restart at the next marker
+    // among the bytes received after it
+    size_t start = 1;
+    while (start < mLength && mBuffer[start] != kStartOfFrame) {
+        ++start;
+    }
+    mSkippedByteCount += start;
+    mLength -= start;
+    memmove(mBuffer, mBuffer + start, mLength);
+}
@@ -0,0 +1,35 @@
+# Stages the content of the LittleFS image.
+#
+# The frontend assets are stored gzip-compressed, each one next to a file with
+# the hash of its content that the web server sends as ETag. index.html
+# references the other assets with their hash in the query, so a browser can
+# cache them forever and still loads new ones after an update.
+#
+# Usage: cmake -DSRC_DIR=<flash_data> -DOUT_DIR=<staging dir> -P <this file>
+
+set(ASSETS style.css server.js)
+
+file(REMOVE_RECURSE ${OUT_DIR})
+file(COPY ${SRC_DIR}/ DESTINATION ${OUT_DIR} PATTERN frontend EXCLUDE)
+file(MAKE_DIRECTORY ${OUT_DIR}/frontend)
+
+function(compress_asset input name)
+    file(SHA256 ${input} hash)
+    string(SUBSTRING ${hash} 0 16 hash)
+    file(ARCHIVE_CREATE OUTPUT ${OUT_DIR}/frontend/${name}.gz
+         PATHS ${input} FORMAT raw COMPRESSION GZip COMPRESSION_LEVEL 9)
+    file(WRITE ${OUT_DIR}/frontend/${name}.etag ${hash})
+    set(hash ${hash} PARENT_SCOPE)
+endfunction()
+
+file(READ ${SRC_DIR}/frontend/index.html index)
+foreach(asset ${ASSETS})
+    compress_asset(${SRC_DIR}/frontend/${asset} ${asset})
+    string(REPLACE "." "\\." pattern ${asset})
+    string(REGEX REPLACE "\"(\\./)?${pattern}\"" "\"${asset}?v=${hash}\""
+           index "${index}")
+endforeach()
+
+file(WRITE ${OUT_DIR}/index.html "${index}")
+compress_asset(${OUT_DIR}/index.html index.html)
+file(REMOVE ${OUT_DIR}/index.html)
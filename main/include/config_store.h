@@ -1,9 +1,12 @@
 #ifndef config_store_h
 #define config_store_h
 
+#include <functional>
 #include <optional>
 #include <vector>
 
+#include "liftplan.h"
+#include "liftplan_parser.h"
 #include "loom_info.h"
 #include "wifi_info.h"
 
@@ -35,24 +38,93 @@ class ConfigStore {
     static std::vector<std::string> listLiftplanFiles();
 
     /**
-     * @brief Load liftplan
+     * @brief Get size of a liftplan file
      *
      * @param[in] fileName Name of the file. It should have a .json extension
-     * @param[out] liftplan Liftplan
-     * @return Content of the liftplan if successfully read
+     * @return Size of the file if it exists
      */
-    static std::optional<std::string> loadLiftplan(const std::string& fileName);
+    static std::optional<size_t> getLiftplanSize(const std::string& fileName);
+
+    /**
+     * @brief Load a range of a liftplan file
+     *
+     * The range is read in fixed-size chunks, so memory usage does not depend
+     * on the size of the liftplan.
+     *
+     * @param[in] fileName Name of the file. It should have a .json extension
+     * @param[in] offset Offset of the range
+     * @param[in] length Length of the range
+     * @param[in] write Function receiving the chunks, returns false to abort
+     * @return True if the whole range is read and written
+     */
+    static bool loadLiftplan(
+        const std::string& fileName, size_t offset, size_t length,
+        const std::function<bool(const char* data, size_t len)>& write);
+
+    /**
+     * @brief Load liftplan by streaming it through a parser
+     *
+     * The file is read in fixed-size chunks, so memory usage does not depend
+     * on the size of the liftplan.
+     *
+     * @param[in] fileName Name of the file. It should have a .json extension
+     * @param[in] parser Parser which receives the content of the file
+     * @return True if the file is read and completely parsed
+     */
+    static bool loadLiftplan(const std::string& fileName,
+                             LiftplanParser& parser);
+
+    /**
+     * @brief Open liftplan for playback
+     *
+     * Picks are played back from the compact binary copy of the liftplan. If
+     * it is missing or corrupted it is recreated from the JSON file.
+     *
+     * @param[in] fileName Name of the file. It should have a .json extension
+     * @param[out] liftplan Liftplan to open
+     * @param[in] verify Verify the checksum of the binary copy
+     * @return True if the liftplan is successfully opened
+     */
+    static bool openLiftplan(const std::string& fileName, Liftplan& liftplan,
+                             bool verify = true);
+
+    /**
+     * @brief Load a window of picks of a liftplan
+     *
+     * The picks are read from the binary copy without verifying its checksum,
+     * they are meant for display only. The binary copy is never recreated
+     * here, so it is safe to call this while the loom task opens the
+     * liftplan.
+     *
+     * @param[in] fileName Name of the file. It should have a .json extension
+     * @param[in] offset Index of the first pick
+     * @param[in] limit Maximal number of picks
+     * @param[in] write Function receiving the picks chunk by chunk, returns
+     * false to abort
+     * @return Number of picks of the whole liftplan if the window is read
+     */
+    static std::optional<unsigned int> loadLiftplanPicks(
+        const std::string& fileName, unsigned int offset, unsigned int limit,
+        const std::function<bool(const uint8_t* picks, size_t count)>& write);
 
     /**
      * @brief Save a liftplan file to file system
      *
+     * Besides the JSON file a compact binary copy, one byte per pick, is saved
+     * which is used for loading the liftplan. The data is written to
+     * temporary files and validated chunk by chunk as it is read, so the size
+     * of a liftplan is limited only by the free space. The files are renamed
+     * once the whole liftplan is valid, a failed upload leaves nothing behind.
+     *
      * @param[in] fileName Name of the file. It should have a .json extension
-     * @param[in] data A JSON array
+     * @param[in] read Function reading the next chunk of the JSON array, it
+     * returns the length of the chunk, 0 at the end and negative on error
      * @return True, if the file is saved. False, if the file with a given name
-     * already exists or other error...
+     * already exists, the data is not a valid liftplan or other error...
      */
-    static bool saveLiftPlan(const std::string& fileName,
-                             const std::string& data);
+    static bool
+    saveLiftPlan(const std::string& fileName,
+                 const std::function<int(char* buffer, size_t size)>& read);
 
     /**
      * @brief Delete a liftplan file
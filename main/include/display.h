@@ -0,0 +1,75 @@
+#ifndef display_h
+#define display_h
+
+#include <cstdint>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "sh1106.h"
+
+#include "screen.h"
+
+namespace hla {
+/**
+ * @brief Asynchronous front end of the OLED display
+ *
+ * Frames are handed over through a depth-1 mailbox and sent to the display by
+ * a dedicated task, so callers never wait for the I2C transfer. Frames which
+ * arrive while a transfer is in flight replace each other and only the latest
+ * one is sent.
+ */
+class Display {
+  public:
+    /**
+     * @brief Constructor
+     *
+     * @param[in] oled Display driver
+     */
+    Display(Sh1106& oled);
+
+    /**
+     * @brief Destructor
+     */
+    ~Display();
+
+    Display(const Display&) = delete;
+    Display& operator=(const Display&) = delete;
+
+    /**
+     * @brief Start the display task
+     */
+    void initialize();
+
+    /**
+     * @brief Queue the last built frame of a screen to be shown on the display
+     *
+     * The frame is copied, so the screen can be rebuilt or destroyed as soon
+     * as the function returns.
+     *
+     * @param[in] screen Screen
+     */
+    void show(const Screen& screen);
+
+    /**
+     * @brief Return number of frames replaced by a newer one before being sent
+     *
+     * @return Number of coalesced frames
+     */
+    uint32_t getCoalescedCount() const;
+
+  private:
+    void loop();
+    static void taskLoop(void* param);
+
+    Sh1106& mOled;
+    uint16_t mFrameSize;
+    uint8_t* mPendingFrame;
+    uint8_t* mFrame;
+    bool mHasPendingFrame;
+    uint32_t mCoalescedCount;
+    SemaphoreHandle_t mMutex;
+    TaskHandle_t mTask;
+};
+}   // namespace hla
+#endif   // display_h
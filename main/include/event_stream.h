@@ -0,0 +1,76 @@
+#ifndef event_stream_h
+#define event_stream_h
+
+#include <atomic>
+#include <cstddef>
+
+#include "esp_http_server.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+namespace hla {
+/**
+ * @brief Server-Sent Events stream pushed to all connected clients
+ *
+ * A client opens the stream with a GET request that is answered with a chunked
+ * text/event-stream response which is never finished. Events are published
+ * from any task into a bounded queue per client and sent from the httpd task,
+ * so publishing never blocks on the network. A client whose queue overflows is
+ * too slow to follow and is disconnected, the browser reconnects and starts
+ * over with the latest event.
+ */
+class EventStream {
+  public:
+    static constexpr size_t kMaxEventSize = 192;
+
+    /**
+     * @brief Constructor
+     */
+    EventStream();
+
+    /**
+     * @brief Handle a request that opens the stream
+     *
+     * The latest event is sent right away.
+     *
+     * @param[in] req Request
+     * @return ESP_OK if the stream is opened
+     */
+    esp_err_t open(httpd_req_t* req);
+
+    /**
+     * @brief Publish an event to all clients
+     *
+     * An event equal to the previous one is not sent again.
+     *
+     * @param[in] data Data of the event, a single line
+     */
+    void publish(const char* data);
+
+  private:
+    static constexpr int kMaxClients = 3;
+    static constexpr int kQueueSize = 8;
+
+    struct Client {
+        EventStream* stream;
+        bool active;
+        bool overflow;
+        httpd_handle_t handle;
+        int fd;
+        char events[kQueueSize][kMaxEventSize];
+        int head;
+        int count;
+    };
+
+    void send();
+    static void sendWork(void* arg);
+    static void onClose(void* ctx);
+
+    SemaphoreHandle_t mMutex;   // guards the clients and the latest event
+    Client mClients[kMaxClients];
+    char mLatest[kMaxEventSize];
+    httpd_handle_t mHandle;
+    std::atomic<bool> mSendQueued;
+};
+}   // namespace hla
+#endif   // event_stream_h
@@ -0,0 +1,91 @@
+#ifndef frame_parser_h
+#define frame_parser_h
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace hla {
+/**
+ * @brief Streaming parser of the frames exchanged with the slider controller
+ *
+ * A frame is a start-of-frame marker followed by cmd, seq, data and a CRC8 of
+ * those three bytes. Bytes may arrive in arbitrary chunks. Bytes before a
+ * marker are skipped, and when the CRC does not match the parser resumes at
+ * the next marker inside the rejected bytes instead of dropping the whole
+ * frame, so a lost or an extra byte costs at most the frame it hits.
+ */
+class FrameParser {
+  public:
+    static constexpr uint8_t kStartOfFrame = 0xA5;
+    static constexpr size_t kFrameSize = 5;
+
+    /**
+     * @brief Decoded frame
+     */
+    struct Frame {
+        uint8_t cmd;
+        uint8_t seq;
+        uint8_t data;
+    };
+
+    /**
+     * @brief Constructor
+     *
+     * @param[in] onFrame Function called for every valid frame
+     */
+    FrameParser(const std::function<void(const Frame&)>& onFrame);
+
+    /**
+     * @brief Drop a partially received frame
+     */
+    void reset();
+
+    /**
+     * @brief Feed received bytes to the parser
+     *
+     * @param[in] data Pointer to the bytes
+     * @param[in] len Number of bytes
+     */
+    void feed(const uint8_t* data, size_t len);
+
+    /**
+     * @brief Get number of frames rejected because of a CRC mismatch
+     * @return number of frames
+     */
+    uint32_t getCrcErrorCount() const;
+
+    /**
+     * @brief Get number of bytes skipped while looking for a marker
+     * @return number of bytes
+     */
+    uint32_t getSkippedByteCount() const;
+
+    /**
+     * @brief Encode a frame
+     *
+     * @param[in] frame Frame to encode
+     * @param[out] buf Buffer of kFrameSize bytes
+     */
+    static void encode(const Frame& frame, uint8_t* buf);
+
+    /**
+     * @brief Calculate CRC8 (polynomial 0x07)
+     *
+     * @param[in] data Pointer to the data
+     * @param[in] len Length of the data
+     * @return CRC8 of the data
+     */
+    static uint8_t crc8(const uint8_t* data, size_t len);
+
+  private:
+    void resync();
+
+    std::function<void(const Frame&)> mOnFrame;
+    uint8_t mBuffer[kFrameSize];
+    size_t mLength;
+    uint32_t mCrcErrorCount;
+    uint32_t mSkippedByteCount;
+};
+}   // namespace hla
+#endif   // frame_parser_h
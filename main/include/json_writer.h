@@ -0,0 +1,89 @@
+#ifndef json_writer_h
+#define json_writer_h
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace hla {
+/**
+ * @brief Streaming JSON writer working on a caller-provided buffer
+ *
+ * The document is written straight into the buffer, commas and escaping are
+ * handled by the writer. A full buffer is passed to the sink and reused, so
+ * documents of any size are written without allocating memory. Once the sink
+ * or the nesting fails, the rest of the document is dropped and finish()
+ * returns false.
+ *
+ * Example:
+ * @code
+ * json.beginObject().key("status").value(true).endObject();
+ * json.finish();
+ * @endcode
+ */
+class JsonWriter {
+  public:
+    /**
+     * @brief Function receiving the written document piece by piece
+     *
+     * @param[in] data Piece of the document
+     * @param[in] len Length of the piece
+     * @param[in] last True for the last piece, passed by finish()
+     * @return False to abort writing
+     */
+    using Sink = std::function<bool(const char* data, size_t len, bool last)>;
+
+    /**
+     * @brief Constructor
+     *
+     * @param[in] buffer Buffer for the document
+     * @param[in] size Size of the buffer
+     * @param[in] sink Function receiving the document
+     */
+    JsonWriter(char* buffer, size_t size, const Sink& sink);
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+
+    /**
+     * @brief Write the key of the next member of an object
+     * @param[in] name Name of the member
+     */
+    JsonWriter& key(const char* name);
+
+    JsonWriter& value(const char* str);
+    JsonWriter& value(const std::string& str);
+    JsonWriter& value(bool b);
+    JsonWriter& value(int n);
+    JsonWriter& value(unsigned int n);
+
+    /**
+     * @brief Pass the rest of the document to the sink
+     * @return True if the whole document is written
+     */
+    bool finish();
+
+  private:
+    static constexpr int kMaxDepth = 32;
+
+    void separate();
+    void push(char bracket);
+    void pop(char bracket);
+    void writeString(const char* str);
+    void write(const char* data, size_t len);
+    void write(char ch);
+
+    char* mBuffer;
+    size_t mSize;
+    size_t mLength;
+    Sink mSink;
+    uint32_t mHasItems;   // one bit per nesting level
+    int mDepth;
+    bool mAfterKey;
+    bool mOk;
+};
+}   // namespace hla
+#endif   // json_writer_h
@@ -0,0 +1,191 @@
+#ifndef liftplan_h
+#define liftplan_h
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+namespace hla {
+/**
+ * @brief Header of a binary liftplan file. It is followed by one byte per pick
+ */
+struct __attribute__((packed)) LiftplanHeader {
+    char magic[4];
+    uint8_t version;
+    uint8_t shaftCount;
+    uint16_t reserved;
+    uint32_t pickCount;
+    uint32_t crc;   // CRC32 of the picks
+};
+
+/**
+ * @brief Read-only liftplan played back directly from a binary liftplan file
+ *
+ * Picks are not loaded into RAM. They are read on demand through a small page
+ * cache, so the size of a liftplan is limited by the size of the flash and not
+ * by the free heap. The file is accessed through the standard file API, so the
+ * same code runs on top of LittleFS and on a regular file system of the host.
+ */
+class Liftplan {
+  public:
+    class Cursor {
+      public:
+        /**
+         * @brief Constructor
+         *
+         * @param[in] liftplan Pointer to the liftplan, nullptr for an invalid
+         * cursor
+         * @param[in] index Index of the pick in the liftplan
+         */
+        Cursor(Liftplan* liftplan, int index = 0);
+
+        /**
+         * @brief Return the pick that the cursor points to
+         * @return the pick
+         */
+        uint8_t value() const;
+
+        /**
+         * @brief Return the index of the pick the cursor points to
+         * @return the index
+         */
+        int index() const;
+
+        /**
+         * @brief Move cursor to the next pick, wraps around at the end
+         */
+        Cursor next() const;
+
+        /**
+         * @brief Move cursor to the previous pick, wraps around at the
+         * beginning
+         */
+        Cursor prev() const;
+
+        /**
+         * @brief Check if the cursor is valid
+         * @return True if valid, false if invalid
+         */
+        bool isValid() const;
+
+        /**
+         * @brief Reset cursor
+         */
+        void reset();
+
+      private:
+        Liftplan* mLiftplan;
+        int mIndex;
+    };
+
+    /**
+     * @brief Constructor
+     */
+    Liftplan();
+
+    /**
+     * @brief Destructor
+     */
+    ~Liftplan() = default;
+
+    Liftplan(const Liftplan&) = delete;
+    Liftplan& operator=(const Liftplan&) = delete;
+
+    /**
+     * @brief Open a binary liftplan file
+     *
+     * The header, the size and optionally the checksum of the picks are
+     * verified. Verifying the checksum reads the whole file, so it can be
+     * skipped when only a few picks are read for display.
+     *
+     * @param[in] path Path of the file
+     * @param[in] verify Verify the checksum of the picks
+     * @return True if the file is a valid binary liftplan
+     */
+    bool open(const std::string& path, bool verify = true);
+
+    /**
+     * @brief Close the liftplan file
+     */
+    void close();
+
+    /**
+     * @brief Get number of picks
+     * @return number of picks, 0 if no file is open
+     */
+    int length() const;
+
+    /**
+     * @brief Get the pick at a given index
+     * @param[in] index Index of the pick
+     * @return the pick, or 0 (all shafts lowered) if it cannot be read
+     */
+    uint8_t at(int index);
+
+    /**
+     * @brief Get a cursor that points to a pick at a given index
+     * @param[in] index Index of the pick
+     * @return cursor, invalid if the index is out of range
+     */
+    Cursor cursorAt(int index);
+
+  private:
+    static constexpr int kPageSize = 256;
+    static constexpr int kPageCount = 2;
+
+    struct Page {
+        int number = -1;
+        uint8_t data[kPageSize];
+    };
+
+    std::ifstream mFile;
+    int mLength;
+    Page mPages[kPageCount];
+    int mNextVictim;
+};
+
+/**
+ * @brief Writer of binary liftplan files
+ *
+ * Picks are written as they come, so a liftplan can be converted without
+ * keeping it in RAM.
+ */
+class LiftplanWriter {
+  public:
+    /**
+     * @brief Constructor
+     */
+    LiftplanWriter();
+
+    /**
+     * @brief Create the file and write a placeholder header
+     * @param[in] path Path of the file
+     * @return True if the file is created
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Append a pick
+     * @param[in] pick Pick
+     */
+    void write(uint8_t pick);
+
+    /**
+     * @brief Flush pending picks and write the final header
+     * @return True if everything is successfully written
+     */
+    bool close();
+
+  private:
+    static constexpr size_t kChunkSize = 256;
+
+    void flush();
+
+    std::ofstream mFile;
+    LiftplanHeader mHeader;
+    uint8_t mUsedShafts;
+    uint8_t mChunk[kChunkSize];
+    size_t mChunkLength;
+};
+}   // namespace hla
+#endif   // liftplan_h
@@ -0,0 +1,75 @@
+#ifndef liftplan_parser_h
+#define liftplan_parser_h
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace hla {
+/**
+ * @brief Incremental parser for liftplans in JSON format
+ *
+ * A liftplan is a JSON array of hex strings, e.g. ["0x01", "0x03"]. The parser
+ * consumes the input in arbitrary sized chunks and emits every pick as soon as
+ * it is parsed, so neither the whole file nor a JSON tree has to be kept in
+ * memory.
+ */
+class LiftplanParser {
+  public:
+    /**
+     * @brief Constructor
+     *
+     * @param[in] onPick Function called for every parsed pick
+     */
+    LiftplanParser(const std::function<void(uint8_t)>& onPick);
+
+    /**
+     * @brief Reset the parser to its initial state
+     */
+    void reset();
+
+    /**
+     * @brief Feed a chunk of the liftplan to the parser
+     *
+     * @param[in] data Pointer to the chunk
+     * @param[in] len Length of the chunk in bytes
+     * @return False if the input is not a valid liftplan, otherwise true
+     */
+    bool feed(const char* data, size_t len);
+
+    /**
+     * @brief Check whether the whole liftplan is parsed
+     *
+     * @return True if the closing bracket of the array was reached
+     */
+    bool isComplete() const;
+
+    /**
+     * @brief Return number of parsed picks
+     *
+     * @return number of picks
+     */
+    unsigned int count() const;
+
+  private:
+    enum class State {
+        BeforeArray,
+        BeforeFirstValue,
+        BeforeValue,
+        InValue,
+        AfterValue,
+        Done,
+        Error
+    };
+    static constexpr size_t kMaxValueLength = 4;   // "0xff"
+
+    bool parseValue();
+
+    std::function<void(uint8_t)> mOnPick;
+    State mState;
+    char mValue[kMaxValueLength + 1];
+    size_t mValueLength;
+    unsigned int mCount;
+};
+}   // namespace hla
+#endif   // liftplan_parser_h
@@ -1,13 +1,19 @@
 #ifndef loom_h
 #define loom_h
 
+#include <atomic>
 #include <optional>
 
 #include "esp_event.h"   //for wifi event
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 #include "sh1106.h"
 
 #include "button_handler.h"
-#include "circular_deque.h"
+#include "display.h"
+#include "liftplan.h"
 #include "loom_iface.h"
 #include "loom_info.h"
 #include "main_screen.h"
@@ -16,7 +22,20 @@
 #include "wifi_info.h"
 
 namespace hla {
-
+/**
+ * @brief The loom
+ *
+ * The loom state is owned by a single task. The ILoom callbacks and the
+ * buttons only queue commands for it, the callbacks that change the state wait
+ * for the result, the buttons do not. The state is read through a snapshot
+ * that the task publishes after every command, so readers never see a half
+ * applied transition.
+ *
+ * The task never waits for the slider controller. Moves and commits complete
+ * through callbacks that hand the result back to the task, so a waiting
+ * callback is only held up by the commands queued before it, never by the
+ * UART retries of a move.
+ */
 class Loom : public ILoom, public ButtonHandler {
   public:
     Loom();
@@ -27,21 +46,85 @@ class Loom : public ILoom, public ButtonHandler {
     std::optional<WifiInfo> onGetWifiInfo() const override;
     void onSetWifiInfo(const WifiInfo& wifiInfo) override;
     std::vector<std::string> onGetLiftplans() const override;
-    std::optional<std::string>
-    onGetLiftplan(const std::string& fileName) override;
+    std::optional<size_t>
+    onGetLiftplanSize(const std::string& fileName) override;
+    bool onGetLiftplan(const std::string& fileName, size_t offset,
+                       size_t length, const ChunkWriter& write) override;
+    std::optional<unsigned int>
+    onGetLiftplanPicks(const std::string& fileName, unsigned int offset,
+                       unsigned int limit, const PickWriter& write) override;
     bool onSetLiftPlan(const std::string& fileName,
-                       const std::string& data) override;
+                       const ChunkReader& read) override;
     bool onDeleteLiftPlan(const std::string& fileName) override;
     bool onStart(const std::string& liftplanFileName,
                  unsigned int startPosition) override;
     bool onPause() override;
     bool onContinue() override;
     bool onStop() override;
-    std::string onGetLoomState() const override;
+    bool onSeek(unsigned int index) override;
+    const char* onGetLoomState() const override;
     std::optional<unsigned int> onGetActiveLiftplanIndex() const override;
-    std::optional<std::string> onGetActiveLiftplanName() const override;
+    bool onGetActiveLiftplanName(char* name, size_t size) const override;
+    bool onGetShaftsError() const override;
 
   private:
+    enum class CommandType : uint8_t {
+        Start,
+        Pause,
+        Continue,
+        Stop,
+        Seek,
+        Step,
+        Delete
+    };
+
+    // arguments and result of a command whose caller waits for it
+    struct Request {
+        const std::string* liftplanFileName;
+        unsigned int index;
+        bool result;
+        SemaphoreHandle_t done;
+    };
+
+    struct Command {
+        CommandType type;
+        uint32_t arg;
+        Request* request;   // nullptr if nobody waits for the result
+    };
+
+    // fixed-size copy of the loom info, taking it does not allocate memory
+    struct Snapshot {
+        LoomState state;
+        int liftplanIndex;                        // -1 if none
+        char liftplanName[kMaxLiftplanNameSize];   // empty if none
+    };
+
+    static constexpr int kCommandQueueSize = 8;
+    static constexpr int kMoveOk = 0x100;
+    // a failed move is retried with an exponential backoff, each attempt
+    // already retries on the UART
+    static constexpr int kMaxMoveAttempts = 6;
+    static constexpr TickType_t kMoveRetryDelay = pdMS_TO_TICKS(500);
+    static constexpr TickType_t kMaxMoveRetryDelay = pdMS_TO_TICKS(8000);
+
+    bool execute(CommandType type, Request& request);
+    void post(CommandType type, uint32_t arg);
+    void notify();
+    static void taskLoop(void* param);
+    void loop();
+    bool handle(const Command& command);
+    bool handleStart(const std::string& liftplanFileName,
+                     unsigned int startPosition);
+    bool handlePause();
+    bool handleContinue();
+    bool handleStop();
+    bool handleSeek(unsigned int index);
+    bool handleDelete(const std::string& liftplanFileName);
+    void lowerShafts();
+    void retryMove();
+    void finishLowerShafts();
+    void publishSnapshot();
+    Snapshot getSnapshot() const;
     bool setupLittlefs();
     void setupWifi(const WifiInfo& wifiInfo);
     bool initializeWifiInStationMode(const WifiInfo& wifiInfo);
@@ -49,17 +132,40 @@ class Loom : public ILoom, public ButtonHandler {
     void setupCaptivePortal();
     void startMdnsService(const WifiInfo& wifiInfo);
     void onButtonPressed(gpio_num_t gpio) override;
+    void onButtonRepeated(gpio_num_t gpio) override;
+    void step(gpio_num_t gpio);
+    void moveShafts(uint8_t value);
+    bool commitShafts(SliderController::Direction direction, uint8_t value);
+    void onShaftsMoved(bool ok, uint8_t value);
+    void handleShaftsMoved(bool ok, uint8_t value);
     void resetLiftplan();
     bool loadLiftplan(const std::string& liftplanFileName,
                       unsigned int startPosition);
+    void stageNeighbours();
 
     Sh1106 mOled;
+    Display mDisplay;
     WebServer mWebServer;
     LoomInfo mLoomInfo;
-    CircularDeque<uint8_t> mLiftplan;
-    CircularDeque<uint8_t>::Cursor mLiftplanCursor;
+    Liftplan mLiftplan;
+    Liftplan::Cursor mLiftplanCursor;
     MainScreen mMainScreen;
     SliderController mSliderController;
+    // position of the latest pick stepped to, the shafts follow it with a
+    // single move at a time
+    uint8_t mShaftTarget;
+    bool mShaftsMoving;
+    // result of the move in flight, position | kMoveOk, -1 if none
+    std::atomic<int> mMoveResult;
+    int mMoveAttempts;
+    TickType_t mRetryTime;
+    bool mRetryPending;
+    // the shafts are not at the target after all attempts failed
+    std::atomic<bool> mShaftsError;
+    QueueHandle_t mCommandQueue;
+    TaskHandle_t mTask;
+    SemaphoreHandle_t mSnapshotMutex;
+    Snapshot mSnapshot;
 };
 }   // namespace hla
 #endif   // loom_h
\ No newline at end of file
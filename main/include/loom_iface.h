@@ -1,6 +1,7 @@
 #ifndef loom_iface_h
 #define loom_iface_h
 
+#include <functional>
 #include <optional>
 #include <vector>
 
@@ -15,6 +16,11 @@ class ILoom {
      */
     virtual ~ILoom() = default;
 
+    /**
+     * @brief Size of a buffer for a liftplan name, with the null character
+     */
+    static constexpr size_t kMaxLiftplanNameSize = 64;
+
     /**
      * @brief Return wifi info
      *
@@ -36,26 +42,78 @@ class ILoom {
     virtual std::vector<std::string> onGetLiftplans() const = 0;
 
     /**
-     * @brief Get a liftplan by name
-     * @param[in] name File name
-     * @param[out] liftplan The liftplan in JSON format
+     * @brief Function writing the next chunk of a download
+     *
+     * @param[in] data Chunk
+     * @param[in] len Length of the chunk
+     * @return True if the chunk is sent
+     */
+    using ChunkWriter = std::function<bool(const char* data, size_t len)>;
+
+    /**
+     * @brief Get size of a liftplan
+     * @param[in] fileName Name of the liftplan file
+     * @return Size of the liftplan in JSON format if the liftplan exists
+     */
+    virtual std::optional<size_t>
+    onGetLiftplanSize(const std::string& fileName) = 0;
+
+    /**
+     * @brief Get a range of a liftplan by name
+     * @param[in] fileName Name of the liftplan file
+     * @param[in] offset Offset of the range in the JSON file
+     * @param[in] length Length of the range
+     * @param[in] write Function receiving the range chunk by chunk
      * @return The whether the liftplan is returned successfully
      */
-    virtual std::optional<std::string>
-    onGetLiftplan(const std::string& fileName) = 0;
+    virtual bool onGetLiftplan(const std::string& fileName, size_t offset,
+                               size_t length, const ChunkWriter& write) = 0;
+
+    /**
+     * @brief Function receiving the next chunk of picks
+     *
+     * @param[in] picks Picks
+     * @param[in] count Number of picks
+     * @return True if the picks are sent
+     */
+    using PickWriter = std::function<bool(const uint8_t* picks, size_t count)>;
+
+    /**
+     * @brief Get a window of picks of a liftplan
+     * @param[in] fileName Name of the liftplan file
+     * @param[in] offset Index of the first pick
+     * @param[in] limit Maximal number of picks
+     * @param[in] write Function receiving the picks chunk by chunk
+     * @return Number of picks of the whole liftplan if the window is returned
+     */
+    virtual std::optional<unsigned int>
+    onGetLiftplanPicks(const std::string& fileName, unsigned int offset,
+                       unsigned int limit, const PickWriter& write) = 0;
+
+    /**
+     * @brief Function reading the next chunk of an upload
+     *
+     * @param[out] buffer Buffer for the chunk
+     * @param[in] size Size of the buffer
+     * @return Length of the chunk, 0 at the end and negative on error
+     */
+    using ChunkReader = std::function<int(char* buffer, size_t size)>;
 
     /**
      * @brief Save liftplan to liftplan catalogue
      *
      * @param[in] fileName Name of the liftplan file
-     * @param[in] content JSON array containing the actual liftplan
+     * @param[in] read Function reading the JSON array containing the actual
+     * liftplan chunk by chunk
      * @return True if the plan is successfully saved. Otherwise return false
      */
     virtual bool onSetLiftPlan(const std::string& fileName,
-                               const std::string& data) = 0;
+                               const ChunkReader& read) = 0;
 
     /**
-     * @brief Save liftplan to liftplan catalogue
+     * @brief Delete liftplan from liftplan catalogue
+     *
+     * The liftplan the loom is running or paused on is not deleted.
      *
      * @param[in] fileName Name of the liftplan file
      * @return True, if the file is deleted.
@@ -89,11 +147,18 @@ class ILoom {
      */
     virtual bool onStop() = 0;
 
+    /**
+     * @brief Jump to a given pick of the active liftplan
+     * @param[in] index Index of the pick
+     * @return True if the loom is positioned on the pick, otherwise false
+     */
+    virtual bool onSeek(unsigned int index) = 0;
+
     /**
      * @brief Get loom state
-     * @return the state in string format
+     * @return the state in string format, a string literal
      */
-    virtual std::string onGetLoomState() const = 0;
+    virtual const char* onGetLoomState() const = 0;
 
     /**
      * @brief Get the index of actively running liftplan
@@ -102,10 +167,18 @@ class ILoom {
     virtual std::optional<unsigned int> onGetActiveLiftplanIndex() const = 0;
 
     /**
-     * @brief Get the name of actively running liftplan
-     * @return The name if the loom is in running state
+     * @brief Copy the name of actively running liftplan
+     * @param[out] name Buffer for the name, kMaxLiftplanNameSize is enough
+     * @param[in] size Size of the buffer, not zero
+     * @return True if the loom is in running state
+     */
+    virtual bool onGetActiveLiftplanName(char* name, size_t size) const = 0;
+
+    /**
+     * @brief Check whether the shafts failed to follow the active pick
+     * @return True if the last move failed after all retries
      */
-    virtual std::optional<std::string> onGetActiveLiftplanName() const = 0;
+    virtual bool onGetShaftsError() const = 0;
 };
 }   // namespace hla
 #endif   // loom_iface_h
\ No newline at end of file
@@ -11,7 +11,7 @@ namespace hla {
 /**
  * @brief Enumeration representing loom states
  */
-enum class LoomState { Init, Idle, Running, Paused };
+enum class LoomState { Init, Idle, Running, Pausing, Paused, Stopping };
 
 constexpr const char* loomStateToString(LoomState ls) {
     switch (ls) {
@@ -21,8 +21,12 @@ constexpr const char* loomStateToString(LoomState ls) {
         return "idle";
     case LoomState::Running:
         return "running";
+    case LoomState::Pausing:
+        return "pausing";
     case LoomState::Paused:
         return "paused";
+    case LoomState::Stopping:
+        return "stopping";
     default:
         return "unknown";
     }
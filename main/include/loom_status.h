@@ -0,0 +1,19 @@
+#ifndef loom_status_h
+#define loom_status_h
+
+#include "json_writer.h"
+#include "loom_iface.h"
+
+namespace hla {
+/**
+ * @brief Write the loom status answered to the status polls of the web UI
+ *
+ * The state and the name of the active liftplan are passed straight from the
+ * loom to the writer, a poll does not allocate memory.
+ *
+ * @param[in] json Writer of the response
+ * @param[in] loom Loom whose status is written
+ */
+void writeLoomStatus(JsonWriter& json, const ILoom& loom);
+}   // namespace hla
+#endif   // loom_status_h
@@ -20,14 +20,6 @@ class MainScreen : public Screen {
      */
     ~MainScreen() = default;
 
-    /**
-     * @brief Build main screen based on data provided by user
-     *
-     * @return An array containing the main screen matching the screen
-     * dimensions
-     */
-    virtual uint8_t* build() override;
-
     /**
      * @brief Set Wifi SSID
      *
@@ -58,6 +50,12 @@ class MainScreen : public Screen {
      */
     MainScreen& setLoomPosition(uint8_t prev, uint8_t cur, uint8_t next);
 
+  protected:
+    /**
+     * @brief Render main screen based on data provided by user
+     */
+    virtual void render() override;
+
   private:
     void printLoomPosition(uint16_t x, uint16_t y, uint8_t value);
 
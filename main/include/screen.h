@@ -2,6 +2,7 @@
 #define screen_h
 
 #include <cstdint>
+#include <mutex>
 #include <string>
 
 namespace hla {
@@ -21,17 +22,31 @@ class Screen {
     virtual ~Screen();
 
     /**
-     * @brief Build function that all screens must to implement
+     * @brief Build the screen
      *
-     * This function is used to build the desired screen and store it in the
-     * frame buffer.
+     * The screen is rendered into the back buffer which is then swapped with
+     * the front buffer. Builds from different tasks are serialized and never
+     * touch the frame that is being read through copyFrontBuffer().
      *
-     * @return Return the buffer containing the screen. Buffer size is always
-     * width * height / 8.
+     * @return Reference to this screen
      */
-    virtual uint8_t* build() = 0;
+    Screen& build();
+
+    /**
+     * @brief Copy the last built frame
+     *
+     * @param[out] buffer Buffer of width * height / 8 bytes
+     */
+    void copyFrontBuffer(uint8_t* buffer) const;
 
   protected:
+    /**
+     * @brief Render function that all screens must to implement
+     *
+     * This function is used to draw the desired screen into the back buffer.
+     */
+    virtual void render() = 0;
+
     /**
      * @brief Enumeration describing text alignment
      */
@@ -90,6 +105,19 @@ class Screen {
     void drawRectangle(int16_t x, int16_t y, uint16_t width, uint16_t height,
                        bool fill = false);
 
+    /**
+     * @brief Draw a single 8 pixel high column on desired x, y coordinates
+     *
+     * When y is aligned to a page the column is written directly into the
+     * frame buffer, otherwise it goes through draw().
+     *
+     * @param[in] x X coordianate
+     * @param[in] y Y coordinate
+     * @param[in] column Column pixels, LSB is the top pixel
+     * @param[in] invert Flag indicating drawing in inverted mode
+     */
+    void drawColumn(int16_t x, int16_t y, uint8_t column, bool invert = false);
+
     /**
      * @brief Print a single character on desired x, y coordinates
      *
@@ -138,7 +166,14 @@ class Screen {
 
     uint16_t mWidth;
     uint16_t mHeight;
-    uint8_t* mFrameBuffer;
+    uint8_t* mFrameBuffer;   // back buffer, target of all drawing functions
+
+  private:
+    uint16_t getFrameSize() const;
+
+    uint8_t* mFrontBuffer;
+    std::mutex mRenderMutex;
+    mutable std::mutex mFrontMutex;
 };
 }   // namespace hla
 
@@ -1,12 +1,30 @@
 #ifndef slider_controller_h
 #define slider_controller_h
 
+#include <atomic>
+#include <functional>
+
 #include "driver/gpio.h"
 #include "driver/uart.h"
+#include "frame_parser.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 
 namespace hla {
+/**
+ * @brief Driver of the slider controller connected over UART
+ *
+ * Frames start with a marker, so the receiver resynchronizes after a lost or
+ * a corrupted byte (see FrameParser). Every frame carries a sequence number
+ * and the slider controller echoes it in the response, so a response is
+ * matched to its request and a late response is dropped instead of being
+ * taken for the acknowledgement of a newer request. Several requests can be
+ * in flight, each with its own timeout and number of retries. A retry resends
+ * the frame with the same sequence number, so the slider controller must
+ * acknowledge a duplicate without executing it twice.
+ */
 class SliderController {
   public:
     /**
@@ -14,6 +32,32 @@ class SliderController {
      */
     enum State { Unknown = 0x00, Init = 0x01, Ready = 0x02 };
 
+    /**
+     * @brief Enumeration representing the pick a commit moves to
+     */
+    enum Direction { Next = 0x00, Prev = 0x01 };
+
+    /**
+     * @brief Function called once a request is completed
+     *
+     * It is called from the UART task, so it must not block and must not
+     * call the blocking functions of the controller.
+     *
+     * @param[in] ok true if the slider controller accepted the request
+     */
+    using Callback = std::function<void(bool ok)>;
+
+    /**
+     * @brief Statistics of the acknowledged moves
+     */
+    struct ShaftStatistics {
+        uint32_t moves;        // all moves
+        uint32_t deltaMoves;   // moves sent as a delta
+        uint32_t raised;       // shafts raised
+        uint32_t lowered;      // shafts lowered
+        uint32_t untouched;    // shafts that kept their state
+    };
+
     /**
      * @brief Constructor
      *
@@ -25,9 +69,28 @@ class SliderController {
 
     /**
      * @brief Initialize the controller
+     *
+     * The link starts at 9600 baud and is switched to the fastest baud rate
+     * the slider controller accepts (see negotiateBaudRate()). If several
+     * moves in a row time out, the slider controller may have been reset, so
+     * the link drops back to 9600 baud and the baud rate is negotiated again.
      */
     void initialize();
 
+    /**
+     * @brief Get baud rate of the link
+     * @return baud rate
+     */
+    uint32_t getBaudRate() const;
+
+    /**
+     * @brief Set timeout and number of retries of move requests
+     *
+     * @param[in] timeout Time to wait for a response before a retry
+     * @param[in] retries Number of retries before a request fails
+     */
+    void setRetryPolicy(TickType_t timeout, int retries);
+
     /**
      * @brief Get state
      *
@@ -39,29 +102,165 @@ class SliderController {
     /**
      * @brief Send command to slider controller to move shafts
      *
+     * Once the position of the shafts is known and the slider controller
+     * supports it, only the mask of the shafts that change their state is
+     * sent, so the slider controller does not drive the other shafts. If the
+     * delta is rejected, the position is sent instead. Blocks until the
+     * request is completed or all retries timed out.
+     *
      * @param[in] value Position of shafts
      * @return true if the message is successfully received
      */
     bool sendCommand(uint8_t value);
 
+    /**
+     * @brief Send command to slider controller to move shafts, returns
+     * immediately
+     *
+     * @param[in] value Position of shafts
+     * @param[in] callback Function called once the request is completed
+     */
+    void sendCommand(uint8_t value, const Callback& callback);
+
+    /**
+     * @brief Pre-stage the neighbouring sheds on the slider controller
+     *
+     * The slider controller keeps both positions, so the next move only needs
+     * a commit that carries no position. The positions are sent without
+     * waiting for the acknowledgement, frames are processed in order, so a
+     * following commit always sees them. If the slider controller never
+     * answered a stage request, staging is disabled until the controller is
+     * initialized again and the caller has to fall back to sendCommand().
+     *
+     * @param[in] prev Position of shafts for the previous pick
+     * @param[in] next Position of shafts for the next pick
+     * @return true if both positions are sent
+     */
+    bool stage(uint8_t prev, uint8_t next);
+
+    /**
+     * @brief Move shafts to a previously staged position, returns immediately
+     *
+     * Staged positions are consumed by a commit and by sendCommand(), so
+     * stage() has to be called again before the next commit. If the slider
+     * controller has nothing staged, because a stage request was lost, the
+     * position is sent right away as with sendCommand().
+     *
+     * @param[in] direction Staged position to move to
+     * @param[in] callback Function called once the request is completed, not
+     * called if nothing is staged
+     * @return true if the commit is sent, false if nothing is staged
+     */
+    bool commit(Direction direction, const Callback& callback);
+
+    /**
+     * @brief Check whether the neighbouring sheds are staged
+     * @return true if commit() can be used
+     */
+    bool isStaged() const;
+
+    /**
+     * @brief Get statistics of the shaft transitions
+     * @return statistics since the last reset
+     */
+    ShaftStatistics getShaftStatistics();
+
+    /**
+     * @brief Reset statistics of the shaft transitions
+     */
+    void resetShaftStatistics();
+
   private:
     enum UartMessages {
         StateRequest = 0x10,
         StateResponse = 0x11,
+        BaudRateRequest = 0x12,
+        BaudRateResponse = 0x13,
         CommandRequest = 0x20,
-        CommandResponse = 0x21
+        CommandResponse = 0x21,
+        StagePrevRequest = 0x30,
+        StagePrevResponse = 0x31,
+        StageNextRequest = 0x32,
+        StageNextResponse = 0x33,
+        CommitRequest = 0x40,
+        CommitResponse = 0x41,
+        DeltaRequest = 0x50,
+        DeltaResponse = 0x51
     };
     enum StatusCode { Ok = 0x00, BadState = 0x01, Busy = 0x02 };
-    void send(uint8_t cmd, uint8_t data);
-    bool recv(uint8_t* cmd, uint8_t* data,
-              TickType_t timeout = pdMS_TO_TICKS(20000));
+
+    /**
+     * @brief Function called once a request is completed, with the data of
+     * the response
+     */
+    using ResponseCallback = std::function<void(bool received, uint8_t data)>;
+
+    struct Request {
+        bool active = false;
+        uint8_t seq;
+        uint8_t cmd;
+        uint8_t data;
+        uint8_t responseCmd;
+        TickType_t timeout;
+        TickType_t deadline;
+        int retries;
+        ResponseCallback callback;
+    };
+
+    static constexpr size_t kMaxRequests = 8;
+    static constexpr int kEventQueueSize = 16;
+    static constexpr TickType_t kPollInterval = pdMS_TO_TICKS(20);
+    static constexpr TickType_t kStateTimeout = pdMS_TO_TICKS(1000);
+    // a slider controller without staging support never answers, so do not
+    // wait as long as for a move
+    static constexpr TickType_t kStageTimeout = pdMS_TO_TICKS(200);
+    static constexpr uint32_t kDefaultBaudRate = 9600;
+    // time the slider controller gets to switch after acknowledging a baud
+    // rate, and the time after which it falls back to the default baud rate
+    // when no valid frame arrives at the new one
+    static constexpr TickType_t kBaudRateSwitchDelay = pdMS_TO_TICKS(20);
+    static constexpr TickType_t kBaudRateFallbackDelay = pdMS_TO_TICKS(500);
+    // moves timed out in a row before the baud rate is negotiated again
+    static constexpr int kMaxMoveTimeouts = 3;
+
+    void request(uint8_t cmd, uint8_t data, uint8_t responseCmd,
+                 TickType_t timeout, int retries,
+                 const ResponseCallback& callback);
+    bool call(uint8_t cmd, uint8_t data, uint8_t responseCmd,
+              TickType_t timeout, int retries, uint8_t* responseData);
+    bool negotiateBaudRate();
+    void renegotiateBaudRate();
+    void moveTo(uint8_t value, const Callback& callback);
+    void onMoved(int from, uint8_t to, bool delta);
+    bool wait(const std::function<void(const Callback&)>& start);
+    void complete(uint8_t cmd, uint8_t seq, uint8_t data);
+    void expire();
+    void send(uint8_t cmd, uint8_t seq, uint8_t data);
+    void receive(size_t len);
     static void rxTask(void* param);
-    uint8_t crc8(const uint8_t* data, size_t len);
+    static void linkTask(void* param);
 
     uart_port_t mPort;
     gpio_num_t mTxPin;
     gpio_num_t mRxPin;
-    QueueHandle_t mResponseQueue;
+    QueueHandle_t mEventQueue;
+    FrameParser mParser;
+    SemaphoreHandle_t mMutex;   // guards the requests and the UART TX
+    Request mRequests[kMaxRequests];
+    uint8_t mNextSeq;
+    TickType_t mCommandTimeout;
+    int mCommandRetries;
+    std::atomic<uint32_t> mBaudRate;
+    int mMoveTimeouts;   // moves timed out in a row, only used by the RX task
+    TaskHandle_t mLinkTask;
+    std::atomic<bool> mStagingSupported;
+    std::atomic<bool> mStagingConfirmed;   // a stage request was answered
+    std::atomic<bool> mStaged;
+    std::atomic<uint8_t> mStagedPrev;
+    std::atomic<uint8_t> mStagedNext;
+    std::atomic<bool> mDeltaSupported;
+    std::atomic<int> mPosition;   // last acknowledged position, -1 if unknown
+    ShaftStatistics mShaftStatistics;
 };
 }   // namespace hla
-#endif   // slider_controller_h
\ No newline at end of file
+#endif   // slider_controller_h
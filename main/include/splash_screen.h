@@ -20,13 +20,11 @@ class SplashScreen : public Screen {
      */
     ~SplashScreen() = default;
 
+  protected:
     /**
-     * @brief Build main screen based on data provided by user
-     *
-     * @return An array containing the main screen matching the screen
-     * dimensions
+     * @brief Render splash screen
      */
-    virtual uint8_t* build() override;
+    virtual void render() override;
 };
 }   // namespace hla
 
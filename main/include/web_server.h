@@ -2,10 +2,13 @@
 #define web_server_h
 
 #include <inttypes.h>
+#include <optional>
 
 #include "esp_http_server.h"
 
+#include "event_stream.h"
 #include "loom_iface.h"
+#include "loom_info.h"
 
 namespace hla {
 /**
@@ -27,6 +30,16 @@ class WebServer {
      */
     void initialize();
 
+    /**
+     * @brief Push loom status to the clients of the event stream
+     *
+     * @param[in] loomInfo Loom info
+     * @param[in] pick Position of shafts of the active pick
+     * @param[in] shaftsError True if the shafts failed to follow the pick
+     */
+    void publishLoomStatus(const LoomInfo& loomInfo,
+                           std::optional<uint8_t> pick, bool shaftsError);
+
   private:
     static esp_err_t resourcehandler(httpd_req_t* req);
     static esp_err_t handleGetWifiInfo(httpd_req_t* req);
@@ -39,9 +52,19 @@ class WebServer {
     static esp_err_t handlePauseLoom(httpd_req_t* req);
     static esp_err_t handleContinueLoom(httpd_req_t* req);
     static esp_err_t handleStopLoom(httpd_req_t* req);
+    static esp_err_t handleSeekLoom(httpd_req_t* req);
     static esp_err_t handleLoomLiftplanIndex(httpd_req_t* req);
+    static esp_err_t handleLoomEvents(httpd_req_t* req);
+    static esp_err_t handleGetLiftplanPicks(httpd_req_t* req);
+    static esp_err_t handleLoomPicks(httpd_req_t* req);
+    static esp_err_t sendLiftplan(httpd_req_t* req, ILoom* callback,
+                                  const char* name);
+    static esp_err_t sendPicks(httpd_req_t* req, ILoom* callback,
+                               const std::string& name, unsigned int offset,
+                               unsigned int limit);
 
     ILoom& mCallback;
+    EventStream mEventStream;
 };
 }   // namespace hla
 #endif   // web_server_h
\ No newline at end of file
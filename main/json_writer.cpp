@@ -0,0 +1,169 @@
+#include "json_writer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+using hla::JsonWriter;
+
+JsonWriter::JsonWriter(char* buffer, size_t size, const Sink& sink)
+    : mBuffer(buffer), mSize(size), mLength(0), mSink(sink), mHasItems(0),
+      mDepth(0), mAfterKey(false), mOk(true) {}
+
+JsonWriter& JsonWriter::beginObject() {
+    separate();
+    push('{');
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    pop('}');
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    separate();
+    push('[');
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    pop(']');
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(const char* name) {
+    separate();
+    writeString(name);
+    write(':');
+    mAfterKey = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const char* str) {
+    separate();
+    writeString(str);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const std::string& str) {
+    return value(str.c_str());
+}
+
+JsonWriter& JsonWriter::value(bool b) {
+    separate();
+    if (b) {
+        write("true", 4);
+    } else {
+        write("false", 5);
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(int n) {
+    char number[12];
+    int len = snprintf(number, sizeof(number), "%d", n);
+    separate();
+    write(number, len);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(unsigned int n) {
+    char number[12];
+    int len = snprintf(number, sizeof(number), "%u", n);
+    separate();
+    write(number, len);
+    return *this;
+}
+
+bool JsonWriter::finish() {
+    // an unfinished document is never passed on as complete
+    mOk = mOk && mDepth == 0 && mSink(mBuffer, mLength, true);
+    mLength = 0;
+    return mOk;
+}
+
+void JsonWriter::separate() {
+    // a value after a key and the first item of a container have no comma
+    if (mAfterKey) {
+        mAfterKey = false;
+        return;
+    }
+    if (mDepth == 0) {
+        return;
+    }
+    uint32_t bit = 1u << (mDepth - 1);
+    if (mHasItems & bit) {
+        write(',');
+    }
+    mHasItems |= bit;
+}
+
+void JsonWriter::push(char bracket) {
+    if (mDepth == kMaxDepth) {
+        mOk = false;
+        return;
+    }
+    write(bracket);
+    ++mDepth;
+    mHasItems &= ~(1u << (mDepth - 1));
+}
+
+void JsonWriter::pop(char bracket) {
+    if (mDepth == 0) {
+        mOk = false;
+        return;
+    }
+    write(bracket);
+    --mDepth;
+}
+
+void JsonWriter::writeString(const char* str) {
+    write('"');
+    for (; *str; ++str) {
+        char ch = *str;
+        switch (ch) {
+        case '"':
+            write("\\\"", 2);
+            break;
+        case '\\':
+            write("\\\\", 2);
+            break;
+        case '\n':
+            write("\\n", 2);
+            break;
+        case '\r':
+            write("\\r", 2);
+            break;
+        case '\t':
+            write("\\t", 2);
+            break;
+        default:
+            if (static_cast<unsigned char>(ch) < 0x20) {
+                char escaped[7];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", ch);
+                write(escaped, 6);
+            } else {
+                write(ch);
+            }
+        }
+    }
+    write('"');
+}
+
+void JsonWriter::write(const char* data, size_t len) {
+    while (len > 0 && mOk) {
+        if (mLength == mSize) {
+            mOk = mSink(mBuffer, mLength, false);
+            mLength = 0;
+            continue;
+        }
+        size_t count = std::min(len, mSize - mLength);
+        memcpy(mBuffer + mLength, data, count);
+        mLength += count;
+        data += count;
+        len -= count;
+    }
+}
+
+void JsonWriter::write(char ch) { write(&ch, 1); }
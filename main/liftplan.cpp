@@ -0,0 +1,187 @@
+#include "liftplan.h"
+
+#include <cstring>
+
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+
+using hla::Liftplan;
+using hla::LiftplanWriter;
+
+static const char* kTag = "liftplan";
+static constexpr char kMagic[4] = {'H', 'L', 'A', 'P'};
+static constexpr uint8_t kVersion = 1;
+
+Liftplan::Cursor::Cursor(Liftplan* liftplan, int index)
+    : mLiftplan(liftplan), mIndex(index) {}
+
+uint8_t Liftplan::Cursor::value() const { return mLiftplan->at(mIndex); }
+
+int Liftplan::Cursor::index() const { return mIndex; }
+
+Liftplan::Cursor Liftplan::Cursor::next() const {
+    if (!isValid()) {
+        return Cursor(nullptr);
+    }
+    int index = mIndex + 1 < mLiftplan->mLength ? mIndex + 1 : 0;
+    return Cursor(mLiftplan, index);
+}
+
+Liftplan::Cursor Liftplan::Cursor::prev() const {
+    if (!isValid()) {
+        return Cursor(nullptr);
+    }
+    int index = mIndex > 0 ? mIndex - 1 : mLiftplan->mLength - 1;
+    return Cursor(mLiftplan, index);
+}
+
+bool Liftplan::Cursor::isValid() const {
+    return mLiftplan != nullptr && mIndex >= 0 && mIndex < mLiftplan->mLength;
+}
+
+void Liftplan::Cursor::reset() {
+    mLiftplan = nullptr;
+    mIndex = 0;
+}
+
+Liftplan::Liftplan() : mLength(0), mNextVictim(0) {}
+
+bool Liftplan::open(const std::string& path, bool verify) {
+    close();
+    mFile.open(path, std::ios::binary);
+    if (!mFile.is_open()) {
+        return false;
+    }
+    LiftplanHeader header;
+    if (!mFile.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        memcmp(header.magic, kMagic, sizeof(header.magic)) != 0 ||
+        header.version != kVersion) {
+        ESP_LOGW(kTag, "Invalid liftplan header: %s", path.c_str());
+        close();
+        return false;
+    }
+    if (!verify) {
+        // a truncated file is still detected without reading the picks
+        mFile.seekg(0, std::ios::end);
+        if (mFile.tellg() != static_cast<std::streamoff>(
+                                 sizeof(header) + header.pickCount)) {
+            ESP_LOGW(kTag, "Truncated liftplan: %s", path.c_str());
+            close();
+            return false;
+        }
+        mLength = header.pickCount;
+        return true;
+    }
+    // verify the picks, one page at a time
+    uint8_t page[kPageSize];
+    uint32_t crc = 0;
+    uint32_t pickCount = 0;
+    while (mFile.read(reinterpret_cast<char*>(page), sizeof(page)) ||
+           mFile.gcount() > 0) {
+        crc = esp_rom_crc32_le(crc, page, mFile.gcount());
+        pickCount += mFile.gcount();
+    }
+    mFile.clear();
+    if (crc != header.crc || pickCount != header.pickCount) {
+        ESP_LOGW(kTag, "Corrupted liftplan: %s", path.c_str());
+        close();
+        return false;
+    }
+    mLength = header.pickCount;
+    return true;
+}
+
+void Liftplan::close() {
+    if (mFile.is_open()) {
+        mFile.close();
+    }
+    mFile.clear();
+    mLength = 0;
+    for (auto& page : mPages) {
+        page.number = -1;
+    }
+    mNextVictim = 0;
+}
+
+int Liftplan::length() const { return mLength; }
+
+uint8_t Liftplan::at(int index) {
+    if (index < 0 || index >= mLength) {
+        return 0;
+    }
+    int number = index / kPageSize;
+    int offset = index % kPageSize;
+    for (const auto& page : mPages) {
+        if (page.number == number) {
+            return page.data[offset];
+        }
+    }
+    // page miss, replace the least recently loaded page
+    Page& page = mPages[mNextVictim];
+    mNextVictim = (mNextVictim + 1) % kPageCount;
+    mFile.seekg(sizeof(LiftplanHeader) + number * kPageSize);
+    if (!mFile.read(reinterpret_cast<char*>(page.data), kPageSize) &&
+        mFile.gcount() <= offset) {
+        ESP_LOGE(kTag, "Failed to read pick %d", index);
+        mFile.clear();
+        page.number = -1;
+        return 0;
+    }
+    mFile.clear();
+    page.number = number;
+    return page.data[offset];
+}
+
+Liftplan::Cursor Liftplan::cursorAt(int index) {
+    return index >= 0 && index < mLength ? Cursor(this, index)
+                                         : Cursor(nullptr);
+}
+
+LiftplanWriter::LiftplanWriter()
+    : mHeader(), mUsedShafts(0), mChunk(), mChunkLength(0) {}
+
+bool LiftplanWriter::open(const std::string& path) {
+    mFile.open(path, std::ios::binary | std::ios::trunc);
+    if (!mFile.is_open()) {
+        return false;
+    }
+    mHeader = {};
+    memcpy(mHeader.magic, kMagic, sizeof(mHeader.magic));
+    mHeader.version = kVersion;
+    mUsedShafts = 0;
+    mChunkLength = 0;
+    // write a placeholder header, it is rewritten once the picks are written
+    mFile.write(reinterpret_cast<const char*>(&mHeader), sizeof(mHeader));
+    return mFile.good();
+}
+
+void LiftplanWriter::write(uint8_t pick) {
+    mChunk[mChunkLength++] = pick;
+    mUsedShafts |= pick;
+    ++mHeader.pickCount;
+    if (mChunkLength == kChunkSize) {
+        flush();
+    }
+}
+
+bool LiftplanWriter::close() {
+    flush();
+    while (mUsedShafts) {
+        ++mHeader.shaftCount;
+        mUsedShafts >>= 1;
+    }
+    mFile.seekp(0);
+    mFile.write(reinterpret_cast<const char*>(&mHeader), sizeof(mHeader));
+    bool result = mFile.good();
+    mFile.close();
+    return result;
+}
+
+void LiftplanWriter::flush() {
+    if (!mChunkLength) {
+        return;
+    }
+    mHeader.crc = esp_rom_crc32_le(mHeader.crc, mChunk, mChunkLength);
+    mFile.write(reinterpret_cast<const char*>(mChunk), mChunkLength);
+    mChunkLength = 0;
+}
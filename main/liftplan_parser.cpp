@@ -0,0 +1,84 @@
+#include "liftplan_parser.h"
+
+#include <cctype>
+#include <cstdlib>
+
+using hla::LiftplanParser;
+
+LiftplanParser::LiftplanParser(const std::function<void(uint8_t)>& onPick)
+    : mOnPick(onPick) {
+    reset();
+}
+
+void LiftplanParser::reset() {
+    mState = State::BeforeArray;
+    mValueLength = 0;
+    mCount = 0;
+}
+
+bool LiftplanParser::feed(const char* data, size_t len) {
+    for (size_t i = 0; i < len && mState != State::Error; ++i) {
+        char ch = data[i];
+        if (mState == State::InValue) {
+            if (ch == '"') {
+                mState = parseValue() ? State::AfterValue : State::Error;
+            } else if (mValueLength < kMaxValueLength) {
+                mValue[mValueLength++] = ch;
+            } else {
+                mState = State::Error;
+            }
+            continue;
+        }
+        if (isspace(static_cast<unsigned char>(ch))) {
+            continue;
+        }
+        switch (mState) {
+        case State::BeforeArray:
+            mState = ch == '[' ? State::BeforeFirstValue : State::Error;
+            break;
+        case State::BeforeFirstValue:
+            if (ch == ']') {
+                mState = State::Done;
+                break;
+            }
+            [[fallthrough]];
+        case State::BeforeValue:
+            mValueLength = 0;
+            mState = ch == '"' ? State::InValue : State::Error;
+            break;
+        case State::AfterValue:
+            if (ch == ',') {
+                mState = State::BeforeValue;
+            } else if (ch == ']') {
+                mState = State::Done;
+            } else {
+                mState = State::Error;
+            }
+            break;
+        default:
+            // nothing but whitespace is allowed after the array
+            mState = State::Error;
+            break;
+        }
+    }
+    return mState != State::Error;
+}
+
+bool LiftplanParser::isComplete() const { return mState == State::Done; }
+
+unsigned int LiftplanParser::count() const { return mCount; }
+
+bool LiftplanParser::parseValue() {
+    if (mValueLength == 0) {
+        return false;
+    }
+    mValue[mValueLength] = '\0';
+    char* end = nullptr;
+    unsigned long value = strtoul(mValue, &end, 16);
+    if (*end != '\0' || value > 0xFF) {
+        return false;
+    }
+    ++mCount;
+    mOnPick(static_cast<uint8_t>(value));
+    return true;
+}
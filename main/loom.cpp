@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cstdio>
 #include <cstring>
 
 #include "dns_server.h"
@@ -13,8 +15,6 @@
 #include "mdns.h"
 #include "nvs_flash.h"   //non volatile storage
 
-#include "cJSON.h"
-
 #include "config_store.h"
 #include "loom.h"
 #include "splash_screen.h"
@@ -41,10 +41,17 @@ static constexpr gpio_num_t kTxPin = GPIO_NUM_18;
 static constexpr gpio_num_t kRxPin = GPIO_NUM_19;
 
 Loom::Loom()
-    : ButtonHandler({kNextButton, kPrevButton}), mWebServer(*this),
+    : ButtonHandler({kNextButton, kPrevButton}), mDisplay(mOled),
+      mWebServer(*this),
       mLiftplanCursor(nullptr),
       mMainScreen(mOled.getWidth(), mOled.getHeight()),
-      mSliderController(kUartPort, kTxPin, kRxPin) {}
+      mSliderController(kUartPort, kTxPin, kRxPin), mShaftTarget(0),
+      mShaftsMoving(false), mMoveResult(-1), mMoveAttempts(0),
+      mRetryTime(0), mRetryPending(false), mShaftsError(false),
+      mTask(nullptr), mSnapshot() {
+    mCommandQueue = xQueueCreate(kCommandQueueSize, sizeof(Command));
+    mSnapshotMutex = xSemaphoreCreateMutex();
+}
 
 void Loom::initialize() {
     ESP_LOGI(kTag, "Initialize LittleFS...");
@@ -56,7 +63,8 @@ void Loom::initialize() {
 
     ESP_LOGI(kTag, "Initialize OLED...");
     mOled.initialize(kI2cNum, kSdaPin, kSclPin);
-    mOled.display(SplashScreen(mOled.getWidth(), mOled.getHeight()).build());
+    mDisplay.initialize();
+    mDisplay.show(SplashScreen(mOled.getWidth(), mOled.getHeight()).build());
     ESP_LOGI(kTag, "Initialize OLED... done");
 
     ESP_LOGI(kTag, "Initialize UART...");
@@ -87,9 +95,20 @@ void Loom::initialize() {
     mWebServer.initialize();
     ESP_LOGI(kTag, "Initialize Web server... done");
 
-    mOled.display(mMainScreen.setUrl(wi.getHostname() + ".local")
+    mDisplay.show(mMainScreen.setUrl(wi.getHostname() + ".local")
                       .setLoomInfo(mLoomInfo)
                       .build());
+
+    // from now on the loom state is only touched by the loom task
+    publishSnapshot();
+    xTaskCreate(taskLoop, "loom_task", 4096, this, 8, &mTask);
+
+    ESP_LOGI(kTag, "Initialize buttons...");
+    if (ButtonHandler::initialize()) {
+        ESP_LOGI(kTag, "Initialize buttons... done");
+    } else {
+        ESP_LOGE(kTag, "Initialize buttons... failed");
+    }
 }
 
 std::optional<WifiInfo> Loom::onGetWifiInfo() const {
@@ -104,62 +123,71 @@ std::vector<std::string> Loom::onGetLiftplans() const {
     return ConfigStore::listLiftplanFiles();
 }
 
-std::optional<std::string> Loom::onGetLiftplan(const std::string& fileName) {
-    return ConfigStore::loadLiftplan(fileName);
+std::optional<size_t> Loom::onGetLiftplanSize(const std::string& fileName) {
+    return ConfigStore::getLiftplanSize(fileName);
+}
+
+bool Loom::onGetLiftplan(const std::string& fileName, size_t offset,
+                         size_t length, const ChunkWriter& write) {
+    return ConfigStore::loadLiftplan(fileName, offset, length, write);
+}
+
+std::optional<unsigned int>
+Loom::onGetLiftplanPicks(const std::string& fileName, unsigned int offset,
+                         unsigned int limit, const PickWriter& write) {
+    return ConfigStore::loadLiftplanPicks(fileName, offset, limit, write);
 }
 
-bool Loom::onSetLiftPlan(const std::string& fileName, const std::string& data) {
-    return ConfigStore::saveLiftPlan(fileName, data);
+bool Loom::onSetLiftPlan(const std::string& fileName,
+                         const ChunkReader& read) {
+    return ConfigStore::saveLiftPlan(fileName, read);
 }
 
 bool Loom::onDeleteLiftPlan(const std::string& fileName) {
-    return ConfigStore::deleteLiftPlan(fileName);
+    Request request = {};
+    request.liftplanFileName = &fileName;
+    return execute(CommandType::Delete, request);
 }
 
-bool Loom::onStart(const std::string& liftplanFileName,
-                   unsigned int startPosition) {
+bool Loom::handleStart(const std::string& liftplanFileName,
+                       unsigned int startPosition) {
     // it is only possible to switch to running from idle state
     if (mLoomInfo.state != LoomState::Idle) {
         ESP_LOGW(kTag,
                  "Failed to switch to 'running' state. Not in 'idle' state.");
         return false;
     }
-    loadLiftplan(liftplanFileName, startPosition);
+    if (!loadLiftplan(liftplanFileName, startPosition)) {
+        return false;
+    }
     // move shafts to match the first element from the liftplan
     ESP_LOGI(kTag, "Moving shatfs to 0x%02x", mLiftplanCursor.value());
-    if (mSliderController.sendCommand(mLiftplanCursor.value())) {
-        ESP_LOGI(kTag, "Switching to 'running' state.");
-        mLoomInfo.state = LoomState::Running;
-    }
-    mOled.display(mMainScreen.setLoomInfo(mLoomInfo)
+    moveShafts(mLiftplanCursor.value());
+    ESP_LOGI(kTag, "Switching to 'running' state.");
+    mLoomInfo.state = LoomState::Running;
+    mDisplay.show(mMainScreen.setLoomInfo(mLoomInfo)
                       .setLoomPosition(mLiftplanCursor.prev().value(),
                                        mLiftplanCursor.value(),
                                        mLiftplanCursor.next().value())
                       .build());
+    stageNeighbours();
     return true;
 }
 
-bool Loom::onPause() {
+bool Loom::handlePause() {
     if (mLoomInfo.state != LoomState::Running) {
         ESP_LOGW(kTag,
                  "Failed to switch to 'pause' state. Not in 'running' state.");
         return false;
     }
-    ESP_LOGI(kTag, "Switching to 'paused' state.");
-    mLoomInfo.state = LoomState::Paused;
-    ConfigStore::saveLoomInfo(mLoomInfo);
-    // lower all shafts
-    ESP_LOGI(kTag, "Lowering all shafts...");
-    while (!mSliderController.sendCommand(0)) {
-        vTaskDelay(1000 / portTICK_PERIOD_MS);
-        ESP_LOGW(kTag, "Lowering all shafts... retry");
-    }
-    ESP_LOGI(kTag, "Lowering all shafts... done");
-    mOled.display(mMainScreen.setLoomInfo(mLoomInfo).build());
+    ESP_LOGI(kTag, "Switching to 'pausing' state.");
+    mLoomInfo.state = LoomState::Pausing;
+    lowerShafts();
+    mDisplay.show(mMainScreen.setLoomInfo(mLoomInfo).build());
     return true;
 }
 
-bool Loom::onContinue() {
+bool Loom::handleContinue() {
     if (mLoomInfo.state != LoomState::Paused) {
         ESP_LOGW(kTag,
                  "Failed to switch to 'running' state. Not in 'paused' state.");
@@ -168,49 +196,282 @@ bool Loom::onContinue() {
     ESP_LOGI(kTag, "Switching to 'running' state.");
     // move shafts to match the first element from the liftplan
     ESP_LOGI(kTag, "Moving shatfs to 0x%02x", mLiftplanCursor.value());
-    if (mSliderController.sendCommand(mLiftplanCursor.value())) {
-        ESP_LOGI(kTag, "Switching to 'running' state.");
-        mLoomInfo.state = LoomState::Running;
-    }
+    moveShafts(mLiftplanCursor.value());
     mLoomInfo.state = LoomState::Running;
     ConfigStore::deleteLoomInfo();
-    mOled.display(mMainScreen.setLoomInfo(mLoomInfo).build());
+    mDisplay.show(mMainScreen.setLoomInfo(mLoomInfo).build());
+    stageNeighbours();
     return true;
 }
 
-bool Loom::onStop() {
+bool Loom::handleStop() {
     // if in "idle" there is nothing to do
-    if (mLoomInfo.state == LoomState::Idle) {
+    if (mLoomInfo.state == LoomState::Idle ||
+        mLoomInfo.state == LoomState::Stopping) {
         return true;
     }
-     // lower all shafts
-    // lower all shafts
+    ESP_LOGI(kTag, "Switching to 'stopping' state.");
+    mLoomInfo.state = LoomState::Stopping;
+    lowerShafts();
+    mDisplay.show(mMainScreen.setLoomInfo(mLoomInfo).build());
+    return true;
+}
+
+void Loom::lowerShafts() {
     ESP_LOGI(kTag, "Lowering all shafts...");
-    while (!mSliderController.sendCommand(0)) {
-        vTaskDelay(1000 / portTICK_PERIOD_MS);
-        ESP_LOGW(kTag, "Lowering all shafts... retry");
+    mMoveAttempts = 0;
+    mRetryPending = false;
+    // a coalesced move still in flight is followed by lowering the shafts
+    moveShafts(0);
+}
+
+void Loom::retryMove() {
+    if (++mMoveAttempts >= kMaxMoveAttempts) {
+        mMoveAttempts = 0;
+        mShaftsError = true;
+        if (mLoomInfo.state == LoomState::Running) {
+            // the position is unknown now, the next step sends it again
+            ESP_LOGE(kTag, "Moving shafts to 0x%02x... failed, giving up",
+                     mShaftTarget);
+        } else {
+            ESP_LOGE(kTag, "Lowering all shafts... failed, giving up");
+            finishLowerShafts();
+        }
+        return;
     }
+    TickType_t delay =
+        std::min(kMoveRetryDelay << (mMoveAttempts - 1), kMaxMoveRetryDelay);
+    ESP_LOGW(kTag, "Moving shafts to 0x%02x... retry in %lu ms", mShaftTarget,
+             static_cast<unsigned long>(pdTICKS_TO_MS(delay)));
+    mRetryTime = xTaskGetTickCount() + delay;
+    mRetryPending = true;
+}
+
+void Loom::finishLowerShafts() {
     ESP_LOGI(kTag, "Lowering all shafts... done");
-    // clear the liftplan buffer, ...
-    resetLiftplan();
-    // switch back to idle state
-    ESP_LOGI(kTag, "Switching to 'idle' state.");
-    mLoomInfo.state = LoomState::Idle;
-    ConfigStore::deleteLoomInfo();
-    mOled.display(mMainScreen.setLoomInfo(mLoomInfo).build());
+    if (mLoomInfo.state == LoomState::Pausing) {
+        ESP_LOGI(kTag, "Switching to 'paused' state.");
+        mLoomInfo.state = LoomState::Paused;
+        ConfigStore::saveLoomInfo(mLoomInfo);
+    } else if (mLoomInfo.state == LoomState::Stopping) {
+        auto statistics = mSliderController.getShaftStatistics();
+        ESP_LOGI(kTag,
+                 "Moves: %lu (%lu delta), shafts raised: %lu, lowered: %lu, "
+                 "untouched: %lu",
+                 static_cast<unsigned long>(statistics.moves),
+                 static_cast<unsigned long>(statistics.deltaMoves),
+                 static_cast<unsigned long>(statistics.raised),
+                 static_cast<unsigned long>(statistics.lowered),
+                 static_cast<unsigned long>(statistics.untouched));
+        mSliderController.resetShaftStatistics();
+        // clear the liftplan buffer, ...
+        resetLiftplan();
+        // switch back to idle state
+        ESP_LOGI(kTag, "Switching to 'idle' state.");
+        mLoomInfo.state = LoomState::Idle;
+        ConfigStore::deleteLoomInfo();
+    }
+    mDisplay.show(mMainScreen.setLoomInfo(mLoomInfo).build());
+}
+
+bool Loom::handleSeek(unsigned int index) {
+    if (mLoomInfo.state != LoomState::Running &&
+        mLoomInfo.state != LoomState::Paused) {
+        ESP_LOGW(kTag, "Failed to seek. Not in 'running' or 'paused' state.");
+        return false;
+    }
+    auto cursor = mLiftplan.cursorAt(index);
+    if (!cursor.isValid()) {
+        ESP_LOGW(kTag, "Failed to seek. Index %u out of range.", index);
+        return false;
+    }
+    // shafts are lowered while paused, they are moved on continue
+    if (mLoomInfo.state == LoomState::Running) {
+        ESP_LOGI(kTag, "Moving shatfs to 0x%02x", cursor.value());
+        moveShafts(cursor.value());
+    }
+    mLiftplanCursor = cursor;
+    mLoomInfo.liftplanIndex = index;
+    if (mLoomInfo.state == LoomState::Paused) {
+        ConfigStore::saveLoomInfo(mLoomInfo);
+    }
+    mDisplay.show(mMainScreen.setLoomInfo(mLoomInfo)
+                      .setLoomPosition(mLiftplanCursor.prev().value(),
+                                       mLiftplanCursor.value(),
+                                       mLiftplanCursor.next().value())
+                      .build());
+    stageNeighbours();
     return true;
 }
 
-std::string Loom::onGetLoomState() const {
-    return loomStateToString(mLoomInfo.state);
+bool Loom::handleDelete(const std::string& liftplanFileName) {
+    // the active liftplan is released when the loom is stopped
+    if (mLoomInfo.liftplanName == liftplanFileName) {
+        ESP_LOGW(kTag, "Failed to delete liftplan. '%s' is active.",
+                 liftplanFileName.c_str());
+        return false;
+    }
+    return ConfigStore::deleteLiftPlan(liftplanFileName);
+}
+
+bool Loom::onStart(const std::string& liftplanFileName,
+                   unsigned int startPosition) {
+    Request request = {};
+    request.liftplanFileName = &liftplanFileName;
+    request.index = startPosition;
+    return execute(CommandType::Start, request);
+}
+
+bool Loom::onPause() {
+    Request request = {};
+    return execute(CommandType::Pause, request);
+}
+
+bool Loom::onContinue() {
+    Request request = {};
+    return execute(CommandType::Continue, request);
+}
+
+bool Loom::onStop() {
+    Request request = {};
+    return execute(CommandType::Stop, request);
+}
+
+bool Loom::onSeek(unsigned int index) {
+    Request request = {};
+    request.index = index;
+    return execute(CommandType::Seek, request);
+}
+
+const char* Loom::onGetLoomState() const {
+    return loomStateToString(getSnapshot().state);
 }
 
 std::optional<unsigned int> Loom::onGetActiveLiftplanIndex() const {
-    return mLoomInfo.liftplanIndex;
+    int index = getSnapshot().liftplanIndex;
+    return index >= 0 ? std::optional<unsigned int>(index) : std::nullopt;
+}
+
+bool Loom::onGetActiveLiftplanName(char* name, size_t size) const {
+    // copied straight from the snapshot, without copying the whole snapshot
+    xSemaphoreTake(mSnapshotMutex, portMAX_DELAY);
+    snprintf(name, size, "%s", mSnapshot.liftplanName);
+    xSemaphoreGive(mSnapshotMutex);
+    return name[0] != '\0';
+}
+
+bool Loom::onGetShaftsError() const { return mShaftsError; }
+
+bool Loom::execute(CommandType type, Request& request) {
+    StaticSemaphore_t buffer;
+    request.done = xSemaphoreCreateBinaryStatic(&buffer);
+    Command command = {type, 0, &request};
+    xQueueSend(mCommandQueue, &command, portMAX_DELAY);
+    notify();
+    xSemaphoreTake(request.done, portMAX_DELAY);
+    vSemaphoreDelete(request.done);
+    return request.result;
+}
+
+void Loom::post(CommandType type, uint32_t arg) {
+    Command command = {type, arg, nullptr};
+    if (xQueueSend(mCommandQueue, &command, 0) != pdTRUE) {
+        ESP_LOGW(kTag, "Command queue full, dropping command %d",
+                 static_cast<int>(type));
+        return;
+    }
+    notify();
 }
 
-std::optional<std::string> Loom::onGetActiveLiftplanName() const {
-    return mLoomInfo.liftplanName;
+void Loom::notify() {
+    // the task is started at the end of initialize(), commands posted before
+    // are handled once it runs
+    if (mTask) {
+        xTaskNotifyGive(mTask);
+    }
+}
+
+void Loom::taskLoop(void* param) {
+    Loom* self = static_cast<Loom*>(param);
+    self->loop();
+}
+
+void Loom::loop() {
+    Command command;
+    while (true) {
+        int moveResult = mMoveResult.exchange(-1);
+        if (moveResult >= 0) {
+            handleShaftsMoved(moveResult & kMoveOk, moveResult & 0xFF);
+            publishSnapshot();
+        }
+        while (xQueueReceive(mCommandQueue, &command, 0) == pdTRUE) {
+            bool result = handle(command);
+            publishSnapshot();
+            if (command.request) {
+                command.request->result = result;
+                xSemaphoreGive(command.request->done);
+            }
+        }
+        TickType_t timeout = portMAX_DELAY;
+        if (mRetryPending) {
+            TickType_t elapsed = xTaskGetTickCount() - mRetryTime;
+            if (static_cast<int32_t>(elapsed) >= 0) {
+                mRetryPending = false;
+                moveShafts(mShaftTarget);
+                continue;
+            }
+            timeout = -elapsed;
+        }
+        ulTaskNotifyTake(pdTRUE, timeout);
+    }
+}
+
+bool Loom::handle(const Command& command) {
+    switch (command.type) {
+    case CommandType::Start:
+        return handleStart(*command.request->liftplanFileName,
+                           command.request->index);
+    case CommandType::Pause:
+        return handlePause();
+    case CommandType::Continue:
+        return handleContinue();
+    case CommandType::Stop:
+        return handleStop();
+    case CommandType::Seek:
+        return handleSeek(command.request->index);
+    case CommandType::Step:
+        step(static_cast<gpio_num_t>(command.arg));
+        return true;
+    case CommandType::Delete:
+        return handleDelete(*command.request->liftplanFileName);
+    }
+    return false;
+}
+
+void Loom::publishSnapshot() {
+    xSemaphoreTake(mSnapshotMutex, portMAX_DELAY);
+    mSnapshot.state = mLoomInfo.state;
+    mSnapshot.liftplanIndex =
+        mLoomInfo.liftplanIndex.has_value() ? mLoomInfo.liftplanIndex.value()
+                                            : -1;
+    snprintf(mSnapshot.liftplanName, sizeof(mSnapshot.liftplanName), "%s",
+             mLoomInfo.liftplanName.has_value()
+                 ? mLoomInfo.liftplanName->c_str()
+                 : "");
+    xSemaphoreGive(mSnapshotMutex);
+    mWebServer.publishLoomStatus(
+        mLoomInfo,
+        mLiftplanCursor.isValid()
+            ? std::optional<uint8_t>(mLiftplanCursor.value())
+            : std::nullopt,
+        mShaftsError);
+}
+
+Loom::Snapshot Loom::getSnapshot() const {
+    xSemaphoreTake(mSnapshotMutex, portMAX_DELAY);
+    Snapshot snapshot = mSnapshot;
+    xSemaphoreGive(mSnapshotMutex);
+    return snapshot;
 }
 
 static EventGroupHandle_t gWifiEventGroup;
@@ -399,89 +660,141 @@ void Loom::startMdnsService(const WifiInfo& wifiInfo) {
 
 void Loom::onButtonPressed(gpio_num_t gpio) {
     ESP_LOGI(kTag, "Pressed GPIO %d", gpio);
+    post(CommandType::Step, gpio);
+}
+
+void Loom::onButtonRepeated(gpio_num_t gpio) {
+    post(CommandType::Step, gpio);
+}
+
+void Loom::step(gpio_num_t gpio) {
     if (mLoomInfo.state != LoomState::Running || !mLiftplanCursor.isValid()) {
         return;
     }
+    SliderController::Direction direction;
     if (gpio == kNextButton) {
-        if (!mSliderController.sendCommand(mLiftplanCursor.next().value())) {
-            return;
-        }
-        mLiftplanCursor = mLiftplanCursor.next();
-        ++(*mLoomInfo.liftplanIndex);
-        (*mLoomInfo.liftplanIndex) %= mLiftplan.length();
+        direction = SliderController::Direction::Next;
     } else if (gpio == kPrevButton) {
-        if (!mSliderController.sendCommand(mLiftplanCursor.prev().value())) {
-            return;
-        }
-        mLiftplanCursor = mLiftplanCursor.prev();
-        if (mLoomInfo.liftplanIndex > 0) {
-            --(*mLoomInfo.liftplanIndex);
-        } else {
-            mLoomInfo.liftplanIndex = mLiftplan.length() - 1;
-        }
+        direction = SliderController::Direction::Prev;
     } else {
         return;
     }
-    // TODO implement me
-    mOled.display(mMainScreen.setLoomInfo(mLoomInfo)
+    auto target = direction == SliderController::Direction::Next
+                      ? mLiftplanCursor.next()
+                      : mLiftplanCursor.prev();
+    // every step is shown, even if the shafts skip it
+    mLiftplanCursor = target;
+    mLoomInfo.liftplanIndex = target.index();
+    mDisplay.show(mMainScreen.setLoomInfo(mLoomInfo)
                       .setLoomPosition(mLiftplanCursor.prev().value(),
                                        mLiftplanCursor.value(),
                                        mLiftplanCursor.next().value())
                       .build());
-    ESP_LOGI(kTag, "Shatfs moved to 0x%02x", mLiftplanCursor.value());
+    // a staged move is a bare commit, it is only valid if the shafts are at
+    // the pick the neighbours were staged for
+    if (mShaftsMoving || !commitShafts(direction, target.value())) {
+        moveShafts(target.value());
+    }
+    stageNeighbours();
+}
+
+void Loom::moveShafts(uint8_t value) {
+    mShaftTarget = value;
+    // steps taken while a move is in flight only update the target, the
+    // shafts go straight to the latest one once the move is done
+    if (mShaftsMoving) {
+        return;
+    }
+    mShaftsMoving = true;
+    // a new move replaces a pending retry
+    mRetryPending = false;
+    mSliderController.sendCommand(
+        value, [this, value](bool ok) { onShaftsMoved(ok, value); });
+}
+
+bool Loom::commitShafts(SliderController::Direction direction,
+                        uint8_t value) {
+    // the commit is a move like any other, steps taken until it is done are
+    // coalesced by moveShafts()
+    if (!mSliderController.commit(
+            direction, [this, value](bool ok) { onShaftsMoved(ok, value); })) {
+        return false;
+    }
+    mShaftTarget = value;
+    mShaftsMoving = true;
+    return true;
+}
+
+void Loom::onShaftsMoved(bool ok, uint8_t value) {
+    // runs in the UART task, it only hands the result over
+    mMoveResult = value | (ok ? kMoveOk : 0);
+    notify();
+}
+
+void Loom::handleShaftsMoved(bool ok, uint8_t value) {
+    if (ok) {
+        ESP_LOGI(kTag, "Shatfs moved to 0x%02x", value);
+    } else {
+        ESP_LOGE(kTag, "Failed to move shafts to 0x%02x", value);
+    }
+    mShaftsMoving = false;
+    if (mShaftTarget != value) {
+        moveShafts(mShaftTarget);
+        // the move consumed the staged neighbours of the latest step
+        stageNeighbours();
+        return;
+    }
+    if (ok) {
+        mMoveAttempts = 0;
+        mShaftsError = false;
+    }
+    if (mLoomInfo.state == LoomState::Pausing ||
+        mLoomInfo.state == LoomState::Stopping) {
+        if (ok) {
+            finishLowerShafts();
+        } else {
+            retryMove();
+        }
+    } else if (!ok && mLoomInfo.state == LoomState::Running) {
+        retryMove();
+    }
 }
 
 void Loom::resetLiftplan() {
     mLoomInfo.liftplanName.reset();
-    mLiftplan.empty();
+    mLiftplan.close();
     mLiftplanCursor.reset();
     mLoomInfo.liftplanLength = std::nullopt;
     mLoomInfo.liftplanIndex = std::nullopt;
 }
 
+void Loom::stageNeighbours() {
+    // staging only makes sense while the shafts follow the liftplan
+    if (mLoomInfo.state != LoomState::Running || !mLiftplanCursor.isValid()) {
+        return;
+    }
+    mSliderController.stage(mLiftplanCursor.prev().value(),
+                            mLiftplanCursor.next().value());
+}
+
 bool Loom::loadLiftplan(const std::string& liftplanFileName,
                         unsigned int startPosition) {
-    // load the raw liftplan from file
-    auto maybeLiftplan = ConfigStore::loadLiftplan(liftplanFileName);
-    if (!maybeLiftplan.has_value()) {
-        ESP_LOGW(kTag,
-                 "Failed to switch to 'running' state. Liftplan not found.");
-        return false;
-    }
-    auto liftplan = maybeLiftplan.value();
-    // parse the liftplan - and load it
     if (mLiftplan.length()) {
         resetLiftplan();
     }
-    cJSON* root = cJSON_Parse(liftplan.c_str());
-    if (!root || !cJSON_IsArray(root)) {
+    if (!ConfigStore::openLiftplan(liftplanFileName, mLiftplan) ||
+        !mLiftplan.length()) {
         ESP_LOGW(
             kTag,
             "Failed to switch to 'running' state. Failed to parse liftplan.");
-        cJSON_Delete(root);
+        resetLiftplan();
         return false;
     }
-    int count = cJSON_GetArraySize(root);
-    for (int i = 0; i < count; i++) {
-        cJSON* item = cJSON_GetArrayItem(root, i);
-        if (!cJSON_IsString(item)) {
-            ESP_LOGW(kTag, "Failed to switch to 'running' state. Failed to "
-                           "parse liftplan.");
-            cJSON_Delete(root);
-            return false;
-        }
-        uint8_t value = (uint8_t) strtoul(item->valuestring, nullptr, 16);
-        mLiftplan.pushBack(value);
-    }
-    cJSON_Delete(root);
     mLoomInfo.liftplanName = liftplanFileName;
     mLoomInfo.liftplanLength = mLiftplan.length();
     // setup the cursor
-    mLiftplanCursor = mLiftplan.frontCursor();
-    for (unsigned int i = 0; i < startPosition; ++i) {
-        mLiftplanCursor = mLiftplanCursor.next();
-    }
-    mLoomInfo.liftplanIndex = startPosition % mLiftplan.length();
+    mLiftplanCursor = mLiftplan.cursorAt(startPosition % mLiftplan.length());
+    mLoomInfo.liftplanIndex = mLiftplanCursor.index();
     mMainScreen.setLoomPosition(mLiftplanCursor.prev().value(),
                                 mLiftplanCursor.value(),
                                 mLiftplanCursor.next().value());
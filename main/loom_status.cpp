@@ -0,0 +1,11 @@
+#include "loom_status.h"
+
+void hla::writeLoomStatus(JsonWriter& json, const ILoom& loom) {
+    char name[ILoom::kMaxLiftplanNameSize];
+    json.beginObject().key("loom_state").value(loom.onGetLoomState());
+    if (loom.onGetActiveLiftplanName(name, sizeof(name))) {
+        json.key("active_liftplan").value(name);
+    }
+    json.key("shafts_error").value(loom.onGetShaftsError());
+    json.endObject();
+}
@@ -8,7 +8,7 @@ using hla::Screen;
 MainScreen::MainScreen(uint16_t width, uint16_t height)
     : Screen(width, height) {}
 
-uint8_t* MainScreen::build() {
+void MainScreen::render() {
     clear();
     int16_t y = 0;
     printString(0, y, "wifi: " + mWifiSsid);
@@ -52,8 +52,6 @@ uint8_t* MainScreen::build() {
         y += 8;
         printLoomPosition(liftplanX, y + 1, mNextLoomPosition);
     }
-
-    return mFrameBuffer;
 }
 
 MainScreen& MainScreen::setWifiSsid(const std::string& value) {
@@ -1,6 +1,7 @@
 #include "screen.h"
 
 #include <cstring>
+#include <utility>
 
 using hla::Screen;
 
@@ -11,7 +12,7 @@ static constexpr uint8_t k_unused = 0x80;
 // Each character has 5 pixels avaliable in width, but it doesn't have to use
 // all 5. If a character uses less than 5 pixels in width, unused pixels are
 // filled with 0x80.
-static const uint8_t k_font[] = {
+static constexpr uint8_t k_font[] = {
     0x00, 0x00,     0x00,     k_unused, k_unused,   // space
     0x5c, k_unused, k_unused, k_unused, k_unused,   // !
     0x0c, 0x00,     0x0c,     k_unused, k_unused,   // "
@@ -109,18 +110,80 @@ static const uint8_t k_font[] = {
     0x08, 0x04,     0x08,     0x04,     k_unused,   // ~
 };
 
+static constexpr uint8_t k_glyph_count = sizeof(k_font) / k_font_width;
+
+// Glyphs derived from k_font at compile time. Widths are precomputed and big
+// glyphs are pre-scaled to twice the size, each column split into an upper and
+// a lower byte.
+struct GlyphTable {
+    uint8_t width[k_glyph_count];
+    uint8_t big[k_glyph_count][k_font_width * 2][2];
+};
+
+static constexpr GlyphTable makeGlyphTable() {
+    GlyphTable table{};
+    for (auto ch = 0; ch < k_glyph_count; ch++) {
+        for (auto i = 0; i < k_font_width; i++) {
+            const uint8_t font_element = k_font[ch * k_font_width + i];
+            if (font_element == k_unused) {
+                continue;
+            }
+            ++table.width[ch];
+            uint8_t upper = 0x00;
+            uint8_t lower = 0x00;
+            for (auto bit = 0; bit < 8; bit++) {
+                if ((1 << bit / 2) & font_element) {
+                    upper |= (1 << bit);
+                }
+                if ((1 << (4 + bit / 2)) & font_element) {
+                    lower |= (1 << bit);
+                }
+            }
+            for (auto j = i * 2; j < i * 2 + 2; j++) {
+                table.big[ch][j][0] = upper;
+                table.big[ch][j][1] = lower;
+            }
+        }
+    }
+    return table;
+}
+
+static constexpr GlyphTable k_glyphs = makeGlyphTable();
+
+static constexpr bool isPrintable(char ch) {
+    return ch >= ' ' && ch - ' ' < k_glyph_count;
+}
+
 Screen::Screen(uint16_t width, uint16_t height)
     : mWidth(width), mHeight(height) {
-    mFrameBuffer = new uint8_t[width * height / 8];
+    mFrameBuffer = new uint8_t[getFrameSize()];
+    mFrontBuffer = new uint8_t[getFrameSize()];
     clear();
+    memset(mFrontBuffer, 0, getFrameSize());
+}
+
+Screen::~Screen() {
+    delete[] mFrameBuffer;
+    delete[] mFrontBuffer;
 }
 
-Screen::~Screen() { delete[] mFrameBuffer; }
+Screen& Screen::build() {
+    std::lock_guard<std::mutex> renderLock(mRenderMutex);
+    render();
+    std::lock_guard<std::mutex> frontLock(mFrontMutex);
+    std::swap(mFrameBuffer, mFrontBuffer);
+    return *this;
+}
 
-void Screen::clear() {
-    memset(mFrameBuffer, 0, sizeof(uint8_t) * (mWidth * mHeight / 8));
+void Screen::copyFrontBuffer(uint8_t* buffer) const {
+    std::lock_guard<std::mutex> lock(mFrontMutex);
+    memcpy(buffer, mFrontBuffer, getFrameSize());
 }
 
+uint16_t Screen::getFrameSize() const { return mWidth * mHeight / 8; }
+
+void Screen::clear() { memset(mFrameBuffer, 0, getFrameSize()); }
+
 void Screen::setPixel(int16_t x, int16_t y) {
     if ((x < 0) || (y < 0) || (x >= mWidth) || (y >= mHeight)) {
         return;
@@ -176,47 +239,39 @@ void Screen::draw(int16_t x, int16_t y, const uint8_t* object, uint16_t width,
     }
 }
 
+void Screen::drawColumn(int16_t x, int16_t y, uint8_t column, bool invert) {
+    if (y % 8 != 0) {
+        draw(x, y, &column, 1, 8, invert);
+        return;
+    }
+    // page aligned, the column maps to exactly one byte of the frame buffer
+    if ((x < 0) || (y < 0) || (x >= mWidth) || (y >= mHeight)) {
+        return;
+    }
+    mFrameBuffer[mWidth * (y / 8) + x] = invert ? ~column : column;
+}
+
 uint16_t Screen::printChar(int16_t x, int16_t y, char ch, bool invert) {
-    auto char_width = 0;
-    for (auto i = 0; i < k_font_width; i++) {
-        if (k_font[(ch - ' ') * 5 + i] != k_unused) {
-            ++char_width;
-        }
+    if (!isPrintable(ch)) {
+        return 0;
+    }
+    const auto glyph = ch - ' ';
+    const auto char_width = k_glyphs.width[glyph];
+    for (auto i = 0; i < char_width; i++) {
+        drawColumn(x + i, y, k_font[glyph * k_font_width + i], invert);
     }
-    draw(x, y, &k_font[(ch - ' ') * k_font_width], char_width, k_font_height,
-         invert);   // draw the character
-    draw(x + char_width, y, 0x00, 1, k_font_height,
-         invert);            // add letter spacing
     return char_width + 1;   // +1 is for letter spacing
 }
 
 uint16_t Screen::printCharBig(int16_t x, int16_t y, char ch, bool invert) {
-    uint8_t font_element, big_font_element = 0x00;
-    uint8_t char_width = 0;
-    for (auto j = 0; j < k_font_width * 2; j++) {
-        font_element = k_font[(ch - ' ') * 5 + j / 2];
-        // skip empty space
-        if (font_element == k_unused) {
-            continue;
-        }
-        ++char_width;
-        // interpolate the upper part of the character element
-        for (auto i = 0; i < 8; i++) {
-            if ((1 << i / 2) & font_element) {
-                big_font_element |= (1 << i);
-            } else {
-                big_font_element &= ~(1 << i);
-            }
-        }
-        draw(x + j, y, &big_font_element, 1, 8, invert);
-        // interpolate the bottom part of the character element
-        for (auto i = 0; i < 8; i++) {
-            if ((1 << (4 + i / 2)) & font_element)
-                big_font_element |= (1 << i);
-            else
-                big_font_element &= ~(1 << i);
-        }
-        draw(x + j, y + 8, &big_font_element, 1, 8, invert);
+    if (!isPrintable(ch)) {
+        return 0;
+    }
+    const auto glyph = ch - ' ';
+    const auto char_width = k_glyphs.width[glyph] * 2;
+    for (auto j = 0; j < char_width; j++) {
+        drawColumn(x + j, y, k_glyphs.big[glyph][j][0], invert);
+        drawColumn(x + j, y + 8, k_glyphs.big[glyph][j][1], invert);
     }
     return char_width + 2;   // +2 is for letter spacing
 }
@@ -231,10 +286,8 @@ uint16_t Screen::printString(int16_t x, int16_t y, const std::string& str,
     if (config.align == TextAlign::Center || config.align == TextAlign::Right) {
         // dry run to calculate width used for alignment
         for (const auto& ch : str) {
-            for (uint8_t i = 0; i < k_font_width; i++) {
-                if (k_font[(ch - ' ') * k_font_width + i] != k_unused) {
-                    ++text_width;
-                }
+            if (isPrintable(ch)) {
+                text_width += k_glyphs.width[ch - ' '];
             }
         }
         text_width += str.size() - 1;   // add letter spacing to text width
@@ -1,6 +1,6 @@
 #include "slider_controller.h"
 
-#include <cstring>
+#include <algorithm>
 #include <utility>
 
 #include "esp_log.h"
@@ -10,13 +10,31 @@ using hla::SliderController;
 
 static const char* kTag = "uart";
 
+// baud rates proposed to the slider controller, fastest first, the code is
+// sent in the BaudRateRequest
+static constexpr struct {
+    uint8_t code;
+    uint32_t baudRate;
+} kBaudRates[] = {{0x02, 230400}, {0x01, 115200}};
+
 SliderController::SliderController(uart_port_t port, gpio_num_t txPin,
                                    gpio_num_t rxPin)
-    : mPort(port), mTxPin(txPin), mRxPin(rxPin), mResponseQueue(nullptr) {}
+    : mPort(port), mTxPin(txPin), mRxPin(rxPin), mEventQueue(nullptr),
+      mParser([this](const FrameParser::Frame& frame) {
+          ESP_LOGI(kTag, "Valid response: 0x%02X seq=%u 0x%02X", frame.cmd,
+                   frame.seq, frame.data);
+          complete(frame.cmd, frame.seq, frame.data);
+      }),
+      mMutex(nullptr),
+      mNextSeq(0), mCommandTimeout(pdMS_TO_TICKS(1000)), mCommandRetries(2),
+      mBaudRate(kDefaultBaudRate), mMoveTimeouts(0), mLinkTask(nullptr),
+      mStagingSupported(true), mStagingConfirmed(false), mStaged(false),
+      mStagedPrev(0), mStagedNext(0), mDeltaSupported(false), mPosition(-1),
+      mShaftStatistics() {}
 
 void SliderController::initialize() {
     uart_config_t config = {};
-    config.baud_rate = 9600;
+    config.baud_rate = kDefaultBaudRate;
     config.data_bits = UART_DATA_8_BITS;
     config.parity = UART_PARITY_DISABLE;
     config.stop_bits = UART_STOP_BITS_1;
@@ -24,82 +42,418 @@ void SliderController::initialize() {
 
     uart_param_config(mPort, &config);
     uart_set_pin(mPort, mTxPin, mRxPin, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
-    uart_driver_install(mPort, 1024 * 2, 0, 0, nullptr, 0);
+    uart_driver_install(mPort, 1024 * 2, 0, kEventQueueSize, &mEventQueue, 0);
 
-    mResponseQueue = xQueueCreate(1, sizeof(uint16_t));
-    xTaskCreate(rxTask, "uart_rx_task", 2048, this, 10, nullptr);
+    mMutex = xSemaphoreCreateMutex();
+    xTaskCreate(rxTask, "uart_rx_task", 3072, this, 10, nullptr);
+    mBaudRate = kDefaultBaudRate;
+    mStagingSupported = true;
+    mStagingConfirmed = false;
+    mStaged = false;
+    mPosition = -1;
+    negotiateBaudRate();
+    // negotiating blocks, so it is done again in a task of its own
+    xTaskCreate(linkTask, "uart_link_task", 3072, this, 9, &mLinkTask);
+    // an empty delta does not move any shaft, it only probes for support
+    uint8_t status = 0;
+    mDeltaSupported = call(UartMessages::DeltaRequest, 0,
+                           UartMessages::DeltaResponse, kStageTimeout, 0,
+                           &status) &&
+                      status == StatusCode::Ok;
+}
+
+uint32_t SliderController::getBaudRate() const { return mBaudRate; }
+
+void SliderController::setRetryPolicy(TickType_t timeout, int retries) {
+    xSemaphoreTake(mMutex, portMAX_DELAY);
+    mCommandTimeout = timeout;
+    mCommandRetries = retries;
+    xSemaphoreGive(mMutex);
 }
 
 bool SliderController::getState(State& state) {
     state = State::Unknown;
-    send(UartMessages::StateRequest, 0);
-    uint8_t recvCmd = 0, recvData = 0;
-    recv(&recvCmd, &recvData);
-    if (recvCmd == UartMessages::StateRequest) {
-        state = static_cast<State>(recvData);
-        return true;
+    uint8_t data = 0;
+    if (!call(UartMessages::StateRequest, 0, UartMessages::StateResponse,
+              kStateTimeout, 0, &data)) {
+        return false;
     }
-    return false;
+    state = static_cast<State>(data);
+    return true;
 }
 
 bool SliderController::sendCommand(uint8_t value) {
-    send(UartMessages::CommandRequest, value);
-    uint8_t recvCmd = 0, recvData = 0;
-    recv(&recvCmd, &recvData);
-    if (recvCmd == UartMessages::CommandResponse &&
-        recvData == StatusCode::Ok) {
-        return true;
+    return wait([&](const Callback& done) { sendCommand(value, done); });
+}
+
+void SliderController::sendCommand(uint8_t value, const Callback& callback) {
+    mStaged = false;
+    int position = mPosition;
+    if (position < 0 || !mDeltaSupported) {
+        moveTo(value, callback);
+        return;
     }
-    return false;
+    // only the shafts whose state changes are sent, the slider controller
+    // raises those that are lowered and lowers those that are raised
+    request(UartMessages::DeltaRequest, position ^ value,
+            UartMessages::DeltaResponse, mCommandTimeout, mCommandRetries,
+            [this, position, value, callback](bool received, uint8_t status) {
+                if (received && status == StatusCode::Ok) {
+                    onMoved(position, value, true);
+                    callback(true);
+                    return;
+                }
+                ESP_LOGW(kTag, "Delta rejected, sending position");
+                moveTo(value, callback);
+            });
+}
+
+bool SliderController::stage(uint8_t prev, uint8_t next) {
+    if (!mStagingSupported) {
+        mStaged = false;
+        return false;
+    }
+    auto onResponse = [this](bool received, uint8_t status) {
+        if (received) {
+            mStagingConfirmed = true;
+        } else if (!mStagingConfirmed) {
+            // once staging was acknowledged, a timeout is a lost frame
+            ESP_LOGW(kTag, "Staging is not supported, falling back to "
+                           "commands");
+            mStagingSupported = false;
+        }
+        if (!received || status != StatusCode::Ok) {
+            mStaged = false;
+        }
+    };
+    mStagedPrev = prev;
+    mStagedNext = next;
+    mStaged = true;
+    request(UartMessages::StagePrevRequest, prev,
+            UartMessages::StagePrevResponse, kStageTimeout, 0, onResponse);
+    request(UartMessages::StageNextRequest, next,
+            UartMessages::StageNextResponse, kStageTimeout, 0, onResponse);
+    return true;
 }
 
-void SliderController::send(uint8_t cmd, uint8_t data) {
-    uint8_t buf[3] = {cmd, data, 0};
-    buf[2] = crc8(buf, 2);
-    uart_write_bytes(mPort, reinterpret_cast<const char*>(buf), 3);
-    ESP_LOGI(kTag, "Sent: cmd=0x%02X, data=0x%02X, crc=0x%02X", cmd, data,
-             buf[2]);
+bool SliderController::commit(Direction direction,
+                              const Callback& callback) {
+    if (!mStaged.exchange(false)) {
+        return false;
+    }
+    int position = mPosition;
+    uint8_t value = direction == Direction::Next ? mStagedNext : mStagedPrev;
+    mPosition = -1;
+    request(UartMessages::CommitRequest, direction,
+            UartMessages::CommitResponse, mCommandTimeout, mCommandRetries,
+            [this, position, value, callback](bool received, uint8_t status) {
+                if (received && status == StatusCode::BadState) {
+                    // a staged position was lost on the way, the shafts did
+                    // not move, so send the position instead
+                    ESP_LOGW(kTag, "Nothing staged, sending position");
+                    mPosition = position;
+                    sendCommand(value, callback);
+                    return;
+                }
+                bool ok = received && status == StatusCode::Ok;
+                if (ok) {
+                    onMoved(position, value, false);
+                }
+                callback(ok);
+            });
+    return true;
+}
+
+bool SliderController::isStaged() const { return mStaged; }
+
+SliderController::ShaftStatistics SliderController::getShaftStatistics() {
+    xSemaphoreTake(mMutex, portMAX_DELAY);
+    ShaftStatistics statistics = mShaftStatistics;
+    xSemaphoreGive(mMutex);
+    return statistics;
+}
+
+void SliderController::resetShaftStatistics() {
+    xSemaphoreTake(mMutex, portMAX_DELAY);
+    mShaftStatistics = {};
+    xSemaphoreGive(mMutex);
+}
+
+void SliderController::moveTo(uint8_t value, const Callback& callback) {
+    int position = mPosition;
+    // unknown until the slider controller acknowledges the move
+    mPosition = -1;
+    request(UartMessages::CommandRequest, value, UartMessages::CommandResponse,
+            mCommandTimeout, mCommandRetries,
+            [this, position, value, callback](bool received, uint8_t status) {
+                bool ok = received && status == StatusCode::Ok;
+                if (ok) {
+                    onMoved(position, value, false);
+                }
+                callback(ok);
+            });
+}
+
+void SliderController::onMoved(int from, uint8_t to, bool delta) {
+    mPosition = to;
+    xSemaphoreTake(mMutex, portMAX_DELAY);
+    ++mShaftStatistics.moves;
+    if (delta) {
+        ++mShaftStatistics.deltaMoves;
+    }
+    if (from >= 0) {
+        uint8_t raised = to & ~from;
+        uint8_t lowered = from & ~to;
+        mShaftStatistics.raised += __builtin_popcount(raised);
+        mShaftStatistics.lowered += __builtin_popcount(lowered);
+        mShaftStatistics.untouched += 8 - __builtin_popcount(raised | lowered);
+    }
+    xSemaphoreGive(mMutex);
+}
+
+bool SliderController::wait(const std::function<void(const Callback&)>& start) {
+    StaticSemaphore_t buffer;
+    SemaphoreHandle_t done = xSemaphoreCreateBinaryStatic(&buffer);
+    bool result = false;
+    // every request is completed, at the latest when its last retry times
+    // out, so it is safe to wait without a timeout
+    start([&](bool ok) {
+        result = ok;
+        xSemaphoreGive(done);
+    });
+    xSemaphoreTake(done, portMAX_DELAY);
+    vSemaphoreDelete(done);
+    return result;
+}
+
+void SliderController::request(uint8_t cmd, uint8_t data, uint8_t responseCmd,
+                               TickType_t timeout, int retries,
+                               const ResponseCallback& callback) {
+    xSemaphoreTake(mMutex, portMAX_DELAY);
+    Request* slot = nullptr;
+    for (auto& request : mRequests) {
+        if (!request.active) {
+            slot = &request;
+            break;
+        }
+    }
+    if (!slot) {
+        xSemaphoreGive(mMutex);
+        ESP_LOGW(kTag, "Too many requests in flight, dropping 0x%02X", cmd);
+        callback(false, 0);
+        return;
+    }
+    // skip sequence numbers of requests that are still in flight
+    bool inUse = true;
+    while (inUse) {
+        inUse = false;
+        for (const auto& request : mRequests) {
+            if (request.active && request.seq == mNextSeq) {
+                inUse = true;
+                ++mNextSeq;
+                break;
+            }
+        }
+    }
+    slot->active = true;
+    slot->seq = mNextSeq++;
+    slot->cmd = cmd;
+    slot->data = data;
+    slot->responseCmd = responseCmd;
+    slot->timeout = timeout;
+    slot->deadline = xTaskGetTickCount() + timeout;
+    slot->retries = retries;
+    slot->callback = callback;
+    send(cmd, slot->seq, data);
+    xSemaphoreGive(mMutex);
 }
 
-bool SliderController::recv(uint8_t* cmd, uint8_t* data, TickType_t timeout) {
-    std::pair<uint8_t, uint8_t> combinedData;
-    bool result =
-        xQueueReceive(mResponseQueue, &combinedData, timeout) == pdTRUE;
-    *cmd = combinedData.first;
-    *data = combinedData.second;
+bool SliderController::call(uint8_t cmd, uint8_t data, uint8_t responseCmd,
+                            TickType_t timeout, int retries,
+                            uint8_t* responseData) {
+    StaticSemaphore_t buffer;
+    SemaphoreHandle_t done = xSemaphoreCreateBinaryStatic(&buffer);
+    bool result = false;
+    // every request is completed, at the latest when its last retry times
+    // out, so it is safe to wait without a timeout
+    request(cmd, data, responseCmd, timeout, retries,
+            [&](bool received, uint8_t value) {
+                result = received;
+                *responseData = value;
+                xSemaphoreGive(done);
+            });
+    xSemaphoreTake(done, portMAX_DELAY);
+    vSemaphoreDelete(done);
     return result;
 }
 
+bool SliderController::negotiateBaudRate() {
+    State state;
+    if (!getState(state)) {
+        ESP_LOGW(kTag, "Slider controller does not answer, staying at %lu",
+                 static_cast<unsigned long>(mBaudRate));
+        return false;
+    }
+    for (const auto& candidate : kBaudRates) {
+        uint8_t status = 0;
+        if (!call(UartMessages::BaudRateRequest, candidate.code,
+                  UartMessages::BaudRateResponse, kStateTimeout, 0, &status)) {
+            // the slider controller does not know the request
+            return false;
+        }
+        if (status != StatusCode::Ok) {
+            continue;
+        }
+        // the slider controller switches once the response is sent
+        uart_set_baudrate(mPort, candidate.baudRate);
+        vTaskDelay(kBaudRateSwitchDelay);
+        if (getState(state)) {
+            mBaudRate = candidate.baudRate;
+            ESP_LOGI(kTag, "Switched to %lu baud",
+                     static_cast<unsigned long>(mBaudRate));
+            return true;
+        }
+        // both sides fall back to the default baud rate, bytes received in
+        // between are skipped by the frame parser
+        ESP_LOGW(kTag, "No response at %lu baud, falling back",
+                 static_cast<unsigned long>(candidate.baudRate));
+        uart_set_baudrate(mPort, kDefaultBaudRate);
+        vTaskDelay(kBaudRateFallbackDelay);
+        if (!getState(state)) {
+            return false;
+        }
+    }
+    return false;
+}
+
+void SliderController::renegotiateBaudRate() {
+    ESP_LOGW(kTag, "%d moves timed out, renegotiating the baud rate",
+             kMaxMoveTimeouts);
+    // the slider controller falls back to the default baud rate when it is
+    // reset or when it gets no valid frame, give it the time to do so
+    uart_set_baudrate(mPort, kDefaultBaudRate);
+    mBaudRate = kDefaultBaudRate;
+    vTaskDelay(kBaudRateFallbackDelay);
+    // a reset slider controller forgot the position and the staged moves
+    mStaged = false;
+    mPosition = -1;
+    negotiateBaudRate();
+}
+
+void SliderController::complete(uint8_t cmd, uint8_t seq, uint8_t data) {
+    ResponseCallback callback;
+    xSemaphoreTake(mMutex, portMAX_DELAY);
+    for (auto& request : mRequests) {
+        if (request.active && request.seq == seq &&
+            request.responseCmd == cmd) {
+            request.active = false;
+            callback = std::move(request.callback);
+            break;
+        }
+    }
+    xSemaphoreGive(mMutex);
+    if (!callback) {
+        ESP_LOGW(kTag, "Stale response: 0x%02X seq=%u", cmd, seq);
+        return;
+    }
+    mMoveTimeouts = 0;
+    callback(true, data);
+}
+
+void SliderController::expire() {
+    ResponseCallback expired[kMaxRequests];
+    size_t count = 0;
+    TickType_t now = xTaskGetTickCount();
+    xSemaphoreTake(mMutex, portMAX_DELAY);
+    for (auto& request : mRequests) {
+        if (!request.active ||
+            static_cast<int32_t>(now - request.deadline) < 0) {
+            continue;
+        }
+        if (request.retries > 0) {
+            --request.retries;
+            request.deadline = now + request.timeout;
+            ESP_LOGW(kTag, "Timeout, resending 0x%02X seq=%u", request.cmd,
+                     request.seq);
+            send(request.cmd, request.seq, request.data);
+        } else {
+            ESP_LOGW(kTag, "Timeout: 0x%02X seq=%u", request.cmd, request.seq);
+            request.active = false;
+            expired[count++] = std::move(request.callback);
+            if (request.cmd == UartMessages::CommandRequest ||
+                request.cmd == UartMessages::DeltaRequest ||
+                request.cmd == UartMessages::CommitRequest) {
+                ++mMoveTimeouts;
+            }
+        }
+    }
+    xSemaphoreGive(mMutex);
+    if (mMoveTimeouts >= kMaxMoveTimeouts && mLinkTask) {
+        mMoveTimeouts = 0;
+        xTaskNotifyGive(mLinkTask);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        expired[i](false, 0);
+    }
+}
+
+void SliderController::send(uint8_t cmd, uint8_t seq, uint8_t data) {
+    uint8_t buf[FrameParser::kFrameSize];
+    FrameParser::encode({cmd, seq, data}, buf);
+    uart_write_bytes(mPort, reinterpret_cast<const char*>(buf), sizeof(buf));
+    ESP_LOGI(kTag, "Sent: cmd=0x%02X, seq=%u, data=0x%02X, crc=0x%02X", cmd,
+             seq, data, buf[4]);
+}
+
+void SliderController::receive(size_t len) {
+    uint8_t buf[64];
+    while (len > 0) {
+        int read = uart_read_bytes(mPort, buf, std::min(len, sizeof(buf)), 0);
+        if (read <= 0) {
+            break;
+        }
+        mParser.feed(buf, read);
+        len -= read;
+    }
+}
+
 void SliderController::rxTask(void* param) {
     SliderController* self = static_cast<SliderController*>(param);
-    uint8_t buf[3];
+    uart_event_t event;
 
     while (true) {
-        int len = uart_read_bytes(self->mPort, buf, sizeof(buf),
-                                  pdMS_TO_TICKS(20000));
-        if (len == 3) {
-            uint8_t crc = self->crc8(buf, 2);
-            if (crc == buf[2]) {
-                auto combined = std::make_pair(buf[0], buf[1]);
-                xQueueSend(self->mResponseQueue, &combined, portMAX_DELAY);
-                ESP_LOGI(kTag, "Valid response: 0x%02X 0x%02X", buf[0], buf[1]);
-            } else {
-                ESP_LOGW(kTag, "CRC error");
+        // wake up regularly to handle timeouts
+        if (xQueueReceive(self->mEventQueue, &event, kPollInterval) ==
+            pdTRUE) {
+            switch (event.type) {
+            case UART_DATA:
+                self->receive(event.size);
+                break;
+            case UART_FIFO_OVF:
+            case UART_BUFFER_FULL:
+                // bytes are lost, the pending requests time out and retry
+                ESP_LOGW(kTag, "RX overflow");
+                uart_flush_input(self->mPort);
+                xQueueReset(self->mEventQueue);
+                self->mParser.reset();
+                break;
+            case UART_FRAME_ERR:
+            case UART_PARITY_ERR:
+                // the parser skips the broken frame
+                ESP_LOGW(kTag, "RX error %d", event.type);
+                break;
+            default:
+                break;
             }
         }
+        self->expire();
     }
 }
 
-uint8_t SliderController::crc8(const uint8_t* data, size_t len) {
-    uint8_t crc = 0x00;   // Initial value
-    for (size_t i = 0; i < len; ++i) {
-        crc ^= data[i];
-        for (uint8_t j = 0; j < 8; ++j) {
-            if (crc & 0x80)
-                crc = (crc << 1) ^ 0x07;
-            else
-                crc <<= 1;
-        }
+void SliderController::linkTask(void* param) {
+    SliderController* self = static_cast<SliderController*>(param);
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        self->renegotiateBaudRate();
     }
-    return crc;
-}
\ No newline at end of file
+}
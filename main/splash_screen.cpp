@@ -6,7 +6,7 @@ using hla::SplashScreen;
 SplashScreen::SplashScreen(uint16_t width, uint16_t height)
     : Screen(width, height) {}
 
-uint8_t* SplashScreen::build() {
+void SplashScreen::render() {
     clear();
 
     const uint16_t imageWidth = 53;
@@ -51,6 +51,4 @@ uint8_t* SplashScreen::build() {
         0x00, 0x00, 0x00, 0x00};
 
     draw(37, 0, bitmap, imageWidth, imageHeight);
-
-    return mFrameBuffer;
 }
\ No newline at end of file
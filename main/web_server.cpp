@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 
@@ -6,27 +8,100 @@
 #include "esp_log.h"
 #include "esp_vfs.h"
 
+#include "json_writer.h"
+#include "loom_status.h"
 #include "web_server.h"
 #include "wifi_info.h"
 
 using hla::ILoom;
+using hla::JsonWriter;
 using hla::WebServer;
 using hla::WifiInfo;
 
 static const char* kTag = "web_server";
+static constexpr unsigned int kDefaultPicksLimit = 100;
+static constexpr unsigned int kMaxPicksLimit = 1000;
+static constexpr size_t kJsonBufferSize = 256;
 static char gScratch[10240];
 
+/**
+ * @brief Send a JSON response written by a function
+ *
+ * The response is written into a buffer on the stack. It is sent in one piece
+ * if it fits, otherwise it is sent in chunks of the size of the buffer.
+ */
+template <typename Write>
+static esp_err_t sendJson(httpd_req_t* req, const Write& write) {
+    char buffer[kJsonBufferSize];
+    bool chunked = false;
+    auto sink = [req, &chunked](const char* data, size_t len, bool last) {
+        if (last && !chunked) {
+            return httpd_resp_send(req, data, len) == ESP_OK;
+        }
+        chunked = true;
+        if (httpd_resp_send_chunk(req, data, len) != ESP_OK) {
+            return false;
+        }
+        return !last || httpd_resp_send_chunk(req, nullptr, 0) == ESP_OK;
+    };
+    JsonWriter json(buffer, sizeof(buffer), sink);
+    httpd_resp_set_type(req, "application/json");
+    write(json);
+    return json.finish() ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t sendStatus(httpd_req_t* req, bool result) {
+    return sendJson(req, [result](JsonWriter& json) {
+        json.beginObject().key("status").value(result).endObject();
+    });
+}
+
+/**
+ * @brief Frontend asset, stored gzip-compressed next to a file with its ETag
+ * (see frontend_assets.cmake)
+ */
+struct Asset {
+    const char* uri;
+    const char* path;
+    const char* type;
+    const char* cacheControl;
+    std::string etag;
+};
+
+// index.html is revalidated on every load, the other assets are referenced
+// with their hash and never change under the same URL
+static Asset gAssets[] = {
+    {"/", "/littlefs/frontend/index.html", "text/html", "no-cache", {}},
+    {"/style.css", "/littlefs/frontend/style.css", "text/css",
+     "public, max-age=31536000, immutable", {}},
+    {"/server.js", "/littlefs/frontend/server.js", "application/javascript",
+     "public, max-age=31536000, immutable", {}},
+};
+
+static void loadAssetTags() {
+    for (auto& asset : gAssets) {
+        std::ifstream file(std::string(asset.path) + ".etag");
+        std::string hash;
+        if (file >> hash) {
+            asset.etag = "\"" + hash + "\"";
+        } else {
+            ESP_LOGW(kTag, "No ETag for %s", asset.path);
+        }
+    }
+}
+
 WebServer::WebServer(ILoom& callback) : mCallback(callback) {}
 
 void WebServer::initialize() {
     httpd_handle_t server = NULL;
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
-    config.max_uri_handlers = 12;
+    config.max_uri_handlers = 16;
     config.uri_match_fn = httpd_uri_match_wildcard;
 
     if (httpd_start(&server, &config) != ESP_OK) {
         return;
     }
+    loadAssetTags();
 
     httpd_uri_t wifiGetUri = {.uri = "/api/v1/wifi",
                               .method = HTTP_GET,
@@ -58,6 +133,12 @@ void WebServer::initialize() {
                                      .user_ctx = &mCallback};
     httpd_register_uri_handler(server, &liftplanDeleteUri);
 
+    httpd_uri_t liftplanPicksGetUri = {.uri = "/api/v1/liftplan/picks",
+                                       .method = HTTP_GET,
+                                       .handler = handleGetLiftplanPicks,
+                                       .user_ctx = &mCallback};
+    httpd_register_uri_handler(server, &liftplanPicksGetUri);
+
     httpd_uri_t loomGetUri = {.uri = "/api/v1/loom",
                               .method = HTTP_GET,
                               .handler = handleGetLoomStatus,
@@ -88,6 +169,12 @@ void WebServer::initialize() {
                                    .user_ctx = &mCallback};
     httpd_register_uri_handler(server, &loomStopPostUri);
 
+    httpd_uri_t loomSeekPostUri = {.uri = "/api/v1/loom/seek",
+                                   .method = HTTP_POST,
+                                   .handler = handleSeekLoom,
+                                   .user_ctx = &mCallback};
+    httpd_register_uri_handler(server, &loomSeekPostUri);
+
     httpd_uri_t loomLiftplanIndexPostUri = {.uri =
                                                 "/api/v1/loom/liftplan_index",
                                             .method = HTTP_GET,
@@ -95,6 +182,18 @@ void WebServer::initialize() {
                                             .user_ctx = &mCallback};
     httpd_register_uri_handler(server, &loomLiftplanIndexPostUri);
 
+    httpd_uri_t loomPicksGetUri = {.uri = "/api/v1/loom/picks",
+                                   .method = HTTP_GET,
+                                   .handler = handleLoomPicks,
+                                   .user_ctx = &mCallback};
+    httpd_register_uri_handler(server, &loomPicksGetUri);
+
+    httpd_uri_t loomEventsGetUri = {.uri = "/api/v1/loom/events",
+                                    .method = HTTP_GET,
+                                    .handler = handleLoomEvents,
+                                    .user_ctx = &mEventStream};
+    httpd_register_uri_handler(server, &loomEventsGetUri);
+
     httpd_uri_t commonGetUri = {.uri = "/*",
                                 .method = HTTP_GET,
                                 .handler = resourcehandler,
@@ -103,21 +202,30 @@ void WebServer::initialize() {
 }
 
 esp_err_t WebServer::resourcehandler(httpd_req_t* req) {
-    std::string filepath;
     std::string uri = req->uri;
-    if (uri == "/") {
-        filepath = "/littlefs/frontend/index.html";
-        httpd_resp_set_type(req, "text/html");
-    } else if (uri == "/style.css") {
-        filepath = "/littlefs/frontend/style.css";
-        httpd_resp_set_type(req, "text/css");
-    } else if (uri == "/server.js") {
-        filepath = "/littlefs/frontend/server.js";
-        httpd_resp_set_type(req, "application/javascript");
-    } else {
-        filepath = "/littlefs/frontend/index.html";
-        httpd_resp_set_type(req, "text/html");
+    uri = uri.substr(0, uri.find('?'));
+    // unknown URIs get index.html
+    const Asset* asset = &gAssets[0];
+    for (const auto& candidate : gAssets) {
+        if (uri == candidate.uri) {
+            asset = &candidate;
+            break;
+        }
     }
+    httpd_resp_set_type(req, asset->type);
+    httpd_resp_set_hdr(req, "Cache-Control", asset->cacheControl);
+    if (!asset->etag.empty()) {
+        httpd_resp_set_hdr(req, "ETag", asset->etag.c_str());
+        char ifNoneMatch[128];
+        if (httpd_req_get_hdr_value_str(req, "If-None-Match", ifNoneMatch,
+                                        sizeof(ifNoneMatch)) == ESP_OK &&
+            strstr(ifNoneMatch, asset->etag.c_str())) {
+            httpd_resp_set_status(req, "304 Not Modified");
+            return httpd_resp_send(req, nullptr, 0);
+        }
+    }
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    std::string filepath = std::string(asset->path) + ".gz";
     std::ifstream file(filepath, std::ios::binary);
     if (!file.is_open()) {
         ESP_LOGE(kTag, "Resourcehandler - Failed to open file : %s",
@@ -154,40 +262,56 @@ esp_err_t WebServer::handleGetWifiInfo(httpd_req_t* req) {
                             "Failed to get WifiInfo");
         return ESP_FAIL;
     }
-    auto wifiInfo = maybeWifiInfo.value();
-    httpd_resp_set_type(req, "application/json");
-    cJSON* root = cJSON_CreateObject();
-    cJSON_AddStringToObject(root, "hostname", wifiInfo.getHostname().c_str());
-    cJSON_AddStringToObject(root, "SSID", wifiInfo.getSSID().c_str());
-    cJSON_AddStringToObject(root, "password", wifiInfo.getPassword().c_str());
-    char* jsonStr = cJSON_Print(root);
-    httpd_resp_sendstr(req, jsonStr);
-    free(static_cast<void*>(jsonStr));
-    cJSON_Delete(root);
-    return ESP_OK;
+    const auto& wifiInfo = maybeWifiInfo.value();
+    return sendJson(req, [&wifiInfo](JsonWriter& json) {
+        json.beginObject()
+            .key("hostname")
+            .value(wifiInfo.getHostname())
+            .key("SSID")
+            .value(wifiInfo.getSSID())
+            .key("password")
+            .value(wifiInfo.getPassword())
+            .endObject();
+    });
 }
 
-esp_err_t WebServer::handleSetWifiInfo(httpd_req_t* req) {
-    ILoom* callback = static_cast<ILoom*>(req->user_ctx);
-    int cur_len = 0;
-    int received = 0;
+/**
+ * @brief Receive the body of a request into the scratch buffer
+ *
+ * The body is null-terminated. If it does not fit or cannot be received, an
+ * error is sent as response.
+ *
+ * @return True if the whole body is received
+ */
+static bool receiveBody(httpd_req_t* req) {
     if (req->content_len >= sizeof(gScratch)) {
-        /* Respond with 500 Internal Server Error */
         httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR,
                             "content too long");
-        return ESP_FAIL;
+        return false;
     }
+    size_t cur_len = 0;
     while (cur_len < req->content_len) {
-        received = httpd_req_recv(req, gScratch + cur_len, req->content_len);
+        int received = httpd_req_recv(req, gScratch + cur_len,
+                                      req->content_len - cur_len);
+        if (received == HTTPD_SOCK_ERR_TIMEOUT) {
+            continue;
+        }
         if (received <= 0) {
-            /* Respond with 500 Internal Server Error */
             httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR,
                                 "Failed to post control value");
-            return ESP_FAIL;
+            return false;
         }
         cur_len += received;
     }
-    gScratch[req->content_len] = '\0';
+    gScratch[cur_len] = '\0';
+    return true;
+}
+
+esp_err_t WebServer::handleSetWifiInfo(httpd_req_t* req) {
+    ILoom* callback = static_cast<ILoom*>(req->user_ctx);
+    if (!receiveBody(req)) {
+        return ESP_FAIL;
+    }
     cJSON* root = cJSON_Parse(gScratch);
     WifiInfo wifiInfo;
     wifiInfo.setHostname(cJSON_GetObjectItem(root, "hostname")->valuestring);
@@ -199,6 +323,99 @@ esp_err_t WebServer::handleSetWifiInfo(httpd_req_t* req) {
     return ESP_OK;
 }
 
+enum class Range { Whole, Partial, Unsatisfiable };
+
+/**
+ * @brief Parse the value of a Range header
+ *
+ * Only a single byte range is supported, anything else is ignored and the
+ * whole resource is sent.
+ */
+static Range parseRange(const char* header, size_t size, size_t& offset,
+                        size_t& length) {
+    if (strncmp(header, "bytes=", 6) != 0 || strchr(header, ',')) {
+        return Range::Whole;
+    }
+    const char* spec = header + 6;
+    char* end;
+    if (*spec == '-') {
+        // the last bytes
+        size_t suffix = strtoul(spec + 1, &end, 10);
+        if (end == spec + 1 || *end) {
+            return Range::Whole;
+        }
+        if (suffix == 0 || size == 0) {
+            return Range::Unsatisfiable;
+        }
+        offset = size - std::min(suffix, size);
+        length = size - offset;
+        return Range::Partial;
+    }
+    size_t first = strtoul(spec, &end, 10);
+    if (end == spec || *end != '-') {
+        return Range::Whole;
+    }
+    const char* lastSpec = end + 1;
+    size_t last = size - 1;
+    if (*lastSpec) {
+        last = strtoul(lastSpec, &end, 10);
+        if (end == lastSpec || *end || last < first) {
+            return Range::Whole;
+        }
+    }
+    if (first >= size) {
+        return Range::Unsatisfiable;
+    }
+    offset = first;
+    length = std::min(last, size - 1) - first + 1;
+    return Range::Partial;
+}
+
+esp_err_t WebServer::sendLiftplan(httpd_req_t* req, ILoom* callback,
+                                  const char* name) {
+    auto size = callback->onGetLiftplanSize(name);
+    if (!size.has_value()) {
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR,
+                                   "Cannot find liftplan");
+    }
+    size_t offset = 0;
+    size_t length = size.value();
+    char contentRange[48];
+    char range[48];
+    httpd_resp_set_hdr(req, "Accept-Ranges", "bytes");
+    if (httpd_req_get_hdr_value_str(req, "Range", range, sizeof(range)) ==
+        ESP_OK) {
+        switch (parseRange(range, size.value(), offset, length)) {
+        case Range::Whole:
+            break;
+        case Range::Partial:
+            snprintf(contentRange, sizeof(contentRange), "bytes %zu-%zu/%zu",
+                     offset, offset + length - 1, size.value());
+            httpd_resp_set_status(req, "206 Partial Content");
+            httpd_resp_set_hdr(req, "Content-Range", contentRange);
+            break;
+        case Range::Unsatisfiable:
+            snprintf(contentRange, sizeof(contentRange), "bytes */%zu",
+                     size.value());
+            httpd_resp_set_status(req, "416 Range Not Satisfiable");
+            httpd_resp_set_hdr(req, "Content-Range", contentRange);
+            return httpd_resp_send(req, nullptr, 0);
+        }
+    }
+    httpd_resp_set_type(req, "application/json");
+    // the file is sent chunk by chunk, it is never held in memory
+    auto write = [req](const char* data, size_t len) {
+        return httpd_resp_send_chunk(req, data, len) == ESP_OK;
+    };
+    if (!callback->onGetLiftplan(name, offset, length, write)) {
+        // the headers may be sent already, close the connection so the
+        // client sees a truncated response
+        ESP_LOGE(kTag, "sendLiftplan - Failed to send %s", name);
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, nullptr, 0);
+}
+
 esp_err_t WebServer::handleGetLiftplan(httpd_req_t* req) {
     ILoom* callback = static_cast<ILoom*>(req->user_ctx);
     char query[100];
@@ -211,27 +428,17 @@ esp_err_t WebServer::handleGetLiftplan(httpd_req_t* req) {
                                        "Missing 'name' param");
         }
         ESP_LOGD(kTag, "handleGetLiftplan - Got name param: %s", name);
-        auto liftplan = callback->onGetLiftplan(name);
-        if (liftplan.has_value()) {
-            httpd_resp_set_type(req, "application/json");
-            httpd_resp_sendstr(req, liftplan.value().c_str());
-        } else {
-            httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR,
-                                "Cannot find liftplan");
-        }
+        return sendLiftplan(req, callback, name);
     } else {
         auto liftplans = callback->onGetLiftplans();
-        httpd_resp_set_type(req, "application/json");
-        cJSON* root = cJSON_CreateArray();
-        for (const auto& liftplan : liftplans) {
-            cJSON_AddItemToArray(root, cJSON_CreateString(liftplan.c_str()));
-        }
-        char* jsonStr = cJSON_Print(root);
-        httpd_resp_sendstr(req, jsonStr);
-        free(static_cast<void*>(jsonStr));
-        cJSON_Delete(root);
+        return sendJson(req, [&liftplans](JsonWriter& json) {
+            json.beginArray();
+            for (const auto& liftplan : liftplans) {
+                json.value(liftplan);
+            }
+            json.endArray();
+        });
     }
-    return ESP_OK;
 }
 
 esp_err_t WebServer::handleSetLiftplan(httpd_req_t* req) {
@@ -248,27 +455,28 @@ esp_err_t WebServer::handleSetLiftplan(httpd_req_t* req) {
                                    "Missing 'name' param");
     }
     ESP_LOGD(kTag, "handleSetLiftplan - Got name param: %s", name);
-    int cur_len = 0;
-    int received = 0;
-    if (req->content_len >= sizeof(gScratch)) {
-        /* Respond with 500 Internal Server Error */
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR,
-                            "content too long");
-        return ESP_FAIL;
-    }
-    while (cur_len < req->content_len) {
-        received = httpd_req_recv(req, gScratch + cur_len, req->content_len);
+    // the body is passed on chunk by chunk, it is never held in memory
+    size_t remaining = req->content_len;
+    auto read = [req, &remaining](char* buffer, size_t size) {
+        if (remaining == 0) {
+            return 0;
+        }
+        int received;
+        do {
+            received = httpd_req_recv(req, buffer, std::min(size, remaining));
+        } while (received == HTTPD_SOCK_ERR_TIMEOUT);
         if (received <= 0) {
-            /* Respond with 500 Internal Server Error */
-            httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR,
-                                "Failed to post control value");
-            return ESP_FAIL;
+            ESP_LOGE(kTag, "handleSetLiftplan - Failed to receive content");
+            return -1;
         }
-        cur_len += received;
+        remaining -= received;
+        return received;
+    };
+    if (!callback->onSetLiftPlan(name, read)) {
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST,
+                                   "Failed to save liftplan");
     }
-    gScratch[req->content_len] = '\0';
-    callback->onSetLiftPlan(name, gScratch);
-    return ESP_OK;
+    return httpd_resp_sendstr(req, "Liftplan saved successfully");
 }
 
 esp_err_t WebServer::handleDeleteLiftplan(httpd_req_t* req) {
@@ -285,130 +493,71 @@ esp_err_t WebServer::handleDeleteLiftplan(httpd_req_t* req) {
                                    "No query params");
     }
     ESP_LOGD(kTag, "handleDeleteLiftplan - Got name param: %s", name);
-    callback->onDeleteLiftPlan(name);
+    if (!callback->onDeleteLiftPlan(name)) {
+        httpd_resp_set_status(req, "409 Conflict");
+        return httpd_resp_sendstr(req,
+                                  "Liftplan is active or does not exist");
+    }
     return httpd_resp_sendstr(req, "File deleted successfully");
 }
 
 esp_err_t WebServer::handleGetLoomStatus(httpd_req_t* req) {
     ILoom* callback = static_cast<ILoom*>(req->user_ctx);
-    std::string loomState = callback->onGetLoomState();
-    httpd_resp_set_type(req, "application/json");
-    cJSON* root = cJSON_CreateObject();
-    if (!root) {
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR,
-                            "Failed to allocate json");
-        return ESP_FAIL;
-    }
-    cJSON_AddStringToObject(root, "loom_state", loomState.c_str());
-    auto maybeLiftplanName = callback->onGetActiveLiftplanName();
-    if (maybeLiftplanName.has_value()) {
-        cJSON_AddStringToObject(root, "active_liftplan",
-                                maybeLiftplanName.value().c_str());
-    }
-
-    char* jsonStr = cJSON_Print(root);
-    httpd_resp_sendstr(req, jsonStr);
-    free(static_cast<void*>(jsonStr));
-    cJSON_Delete(root);
-    return ESP_OK;
+    return sendJson(req, [callback](JsonWriter& json) {
+        writeLoomStatus(json, *callback);
+    });
 }
 
 esp_err_t WebServer::handleStartLoom(httpd_req_t* req) {
     ILoom* callback = static_cast<ILoom*>(req->user_ctx);
     // parse request
-    int cur_len = 0;
-    int received = 0;
-    if (req->content_len >= sizeof(gScratch)) {
-        /* Respond with 500 Internal Server Error */
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR,
-                            "content too long");
+    if (!receiveBody(req)) {
         return ESP_FAIL;
     }
-    while (cur_len < req->content_len) {
-        received = httpd_req_recv(req, gScratch + cur_len, req->content_len);
-        if (received <= 0) {
-            /* Respond with 500 Internal Server Error */
-            httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR,
-                                "Failed to post control value");
-            return ESP_FAIL;
-        }
-        cur_len += received;
-    }
-    gScratch[req->content_len] = '\0';
     cJSON* request = cJSON_Parse(gScratch);
     // set state
     bool result = callback->onStart(
         cJSON_GetObjectItem(request, "liftplan")->valuestring,
         cJSON_GetObjectItem(request, "start_position")->valueint);
     cJSON_Delete(request);
-    // create response
-    httpd_resp_set_type(req, "application/json");
-    cJSON* response = cJSON_CreateObject();
-    if (!response) {
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR,
-                            "Failed to allocate json");
-        return ESP_FAIL;
-    }
-    cJSON_AddBoolToObject(response, "status", result);
-    char* jsonStr = cJSON_Print(response);
-    httpd_resp_sendstr(req, jsonStr);
-    free(static_cast<void*>(jsonStr));
-    cJSON_Delete(response);
-    return ESP_OK;
+    return sendStatus(req, result);
 }
 
 esp_err_t WebServer::handlePauseLoom(httpd_req_t* req) {
     ILoom* callback = static_cast<ILoom*>(req->user_ctx);
     bool result = callback->onPause();
-    httpd_resp_set_type(req, "application/json");
-    cJSON* root = cJSON_CreateObject();
-    if (!root) {
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR,
-                            "Failed to allocate json");
-        return ESP_FAIL;
-    }
-    cJSON_AddBoolToObject(root, "status", result);
-    char* jsonStr = cJSON_Print(root);
-    httpd_resp_sendstr(req, jsonStr);
-    free(static_cast<void*>(jsonStr));
-    cJSON_Delete(root);
-    return ESP_OK;
+    return sendStatus(req, result);
 }
 
 esp_err_t WebServer::handleContinueLoom(httpd_req_t* req) {
     ILoom* callback = static_cast<ILoom*>(req->user_ctx);
     bool result = callback->onContinue();
-    httpd_resp_set_type(req, "application/json");
-    cJSON* root = cJSON_CreateObject();
-    if (!root) {
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR,
-                            "Failed to allocate json");
-        return ESP_FAIL;
-    }
-    cJSON_AddBoolToObject(root, "status", result);
-    char* jsonStr = cJSON_Print(root);
-    httpd_resp_sendstr(req, jsonStr);
-    free(static_cast<void*>(jsonStr));
-    cJSON_Delete(root);
-    return ESP_OK;
+    return sendStatus(req, result);
 }
 
 esp_err_t WebServer::handleStopLoom(httpd_req_t* req) {
     ILoom* callback = static_cast<ILoom*>(req->user_ctx);
     bool result = callback->onStop();
-    httpd_resp_set_type(req, "application/json");
-    cJSON* root = cJSON_CreateObject();
-    if (!root) {
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR,
-                            "Failed to allocate json");
+    return sendStatus(req, result);
+}
+
+esp_err_t WebServer::handleSeekLoom(httpd_req_t* req) {
+    ILoom* callback = static_cast<ILoom*>(req->user_ctx);
+    // parse request
+    if (!receiveBody(req)) {
         return ESP_FAIL;
     }
-    cJSON_AddBoolToObject(root, "status", result);
-    char* jsonStr = cJSON_Print(root);
-    httpd_resp_sendstr(req, jsonStr);
-    free(static_cast<void*>(jsonStr));
-    cJSON_Delete(root);
-    return ESP_OK;
+    cJSON* request = cJSON_Parse(gScratch);
+    cJSON* index = cJSON_GetObjectItem(request, "index");
+    if (!cJSON_IsNumber(index) || index->valueint < 0) {
+        cJSON_Delete(request);
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST,
+                                   "Missing 'index' param");
+    }
+    // set position
+    bool result = callback->onSeek(index->valueint);
+    cJSON_Delete(request);
+    return sendStatus(req, result);
 }
 
 esp_err_t WebServer::handleLoomLiftplanIndex(httpd_req_t* req) {
@@ -419,13 +568,173 @@ esp_err_t WebServer::handleLoomLiftplanIndex(httpd_req_t* req) {
                             "Failed to get active liftplan index");
         return ESP_FAIL;
     }
-    auto liftplanIndex = maybeLiftplanIndex.value();
-    httpd_resp_set_type(req, "application/json");
-    cJSON* root = cJSON_CreateObject();
-    cJSON_AddNumberToObject(root, "index", liftplanIndex);
-    char* jsonStr = cJSON_Print(root);
-    httpd_resp_sendstr(req, jsonStr);
-    free(static_cast<void*>(jsonStr));
-    cJSON_Delete(root);
-    return ESP_OK;
-}
\ No newline at end of file
+    unsigned int liftplanIndex = maybeLiftplanIndex.value();
+    return sendJson(req, [liftplanIndex](JsonWriter& json) {
+        json.beginObject().key("index").value(liftplanIndex).endObject();
+    });
+}
+
+/**
+ * @brief Read an unsigned number from the URL query
+ *
+ * @return False if the parameter is present but is not a number
+ */
+static bool getQueryNumber(const char* query, const char* key,
+                           unsigned int& value) {
+    char buffer[12];
+    esp_err_t err = httpd_query_key_value(query, key, buffer, sizeof(buffer));
+    if (err == ESP_ERR_NOT_FOUND) {
+        return true;
+    }
+    char* end;
+    unsigned long number = strtoul(buffer, &end, 10);
+    if (err != ESP_OK || end == buffer || *end) {
+        return false;
+    }
+    value = number;
+    return true;
+}
+
+esp_err_t WebServer::sendPicks(httpd_req_t* req, ILoom* callback,
+                               const std::string& name, unsigned int offset,
+                               unsigned int limit) {
+    static constexpr char kHexDigits[] = "0123456789abcdef";
+    // the picks are sent as one hex string, two characters per pick
+    bool started = false;
+    char buffer[64];
+    auto write = [&](const uint8_t* picks, size_t count) {
+        if (!started) {
+            httpd_resp_set_type(req, "application/json");
+            int len = snprintf(buffer, sizeof(buffer),
+                               "{\"offset\":%u,\"picks\":\"", offset);
+            if (httpd_resp_send_chunk(req, buffer, len) != ESP_OK) {
+                return false;
+            }
+            started = true;
+        }
+        while (count > 0) {
+            size_t len = 0;
+            for (; count > 0 && len < sizeof(buffer); --count, ++picks) {
+                buffer[len++] = kHexDigits[*picks >> 4];
+                buffer[len++] = kHexDigits[*picks & 0x0f];
+            }
+            if (httpd_resp_send_chunk(req, buffer, len) != ESP_OK) {
+                return false;
+            }
+        }
+        return true;
+    };
+    auto length = callback->onGetLiftplanPicks(name, offset, limit, write);
+    if (!length.has_value()) {
+        if (started) {
+            ESP_LOGE(kTag, "sendPicks - Failed to send %s", name.c_str());
+            return ESP_FAIL;
+        }
+        if (!callback->onGetLiftplanSize(name).has_value()) {
+            return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND,
+                                       "Cannot find liftplan");
+        }
+        // the binary copy is missing or broken, it is recreated when the
+        // liftplan is started
+        httpd_resp_set_status(req, "409 Conflict");
+        return httpd_resp_sendstr(req, "Liftplan is not converted");
+    }
+    if (!started && !write(nullptr, 0)) {
+        return ESP_FAIL;
+    }
+    int len = snprintf(buffer, sizeof(buffer), "\",\"length\":%u}",
+                       length.value());
+    httpd_resp_send_chunk(req, buffer, len);
+    return httpd_resp_send_chunk(req, nullptr, 0);
+}
+
+esp_err_t WebServer::handleGetLiftplanPicks(httpd_req_t* req) {
+    ILoom* callback = static_cast<ILoom*>(req->user_ctx);
+    char query[100];
+    char name[64] = {0};
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK) {
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST,
+                                   "No query params");
+    }
+    if (httpd_query_key_value(query, "name", name, sizeof(name)) != ESP_OK) {
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST,
+                                   "Missing 'name' param");
+    }
+    unsigned int offset = 0;
+    unsigned int limit = kDefaultPicksLimit;
+    if (!getQueryNumber(query, "offset", offset) ||
+        !getQueryNumber(query, "limit", limit)) {
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST,
+                                   "Invalid 'offset' or 'limit' param");
+    }
+    return sendPicks(req, callback, name, offset,
+                     std::min(limit, kMaxPicksLimit));
+}
+
+esp_err_t WebServer::handleLoomPicks(httpd_req_t* req) {
+    ILoom* callback = static_cast<ILoom*>(req->user_ctx);
+    char name[ILoom::kMaxLiftplanNameSize];
+    bool active = callback->onGetActiveLiftplanName(name, sizeof(name));
+    auto index = callback->onGetActiveLiftplanIndex();
+    if (!active) {
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR,
+                                   "No active liftplan");
+    }
+    char query[100] = {0};
+    httpd_req_get_url_query_str(req, query, sizeof(query));
+    unsigned int limit = kDefaultPicksLimit;
+    if (!getQueryNumber(query, "limit", limit)) {
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST,
+                                   "Invalid 'limit' param");
+    }
+    limit = std::min(limit, kMaxPicksLimit);
+    // without an offset the window is centered on the active pick
+    unsigned int activeIndex = index.value_or(0);
+    unsigned int offset =
+        activeIndex > limit / 2 ? activeIndex - limit / 2 : 0;
+    if (!getQueryNumber(query, "offset", offset)) {
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST,
+                                   "Invalid 'offset' param");
+    }
+    return sendPicks(req, callback, name, offset, limit);
+}
+
+esp_err_t WebServer::handleLoomEvents(httpd_req_t* req) {
+    EventStream* eventStream = static_cast<EventStream*>(req->user_ctx);
+    return eventStream->open(req);
+}
+
+void WebServer::publishLoomStatus(const LoomInfo& loomInfo,
+                                  std::optional<uint8_t> pick,
+                                  bool shaftsError) {
+    // one byte is left for the terminating null character
+    char event[EventStream::kMaxEventSize];
+    auto sink = [&event](const char* data, size_t len, bool last) {
+        event[len] = '\0';
+        return last;
+    };
+    JsonWriter json(event, sizeof(event) - 1, sink);
+    json.beginObject();
+    json.key("loom_state").value(loomStateToString(loomInfo.state));
+    if (loomInfo.liftplanName.has_value()) {
+        json.key("active_liftplan").value(loomInfo.liftplanName.value());
+    }
+    if (loomInfo.liftplanIndex.has_value()) {
+        json.key("index").value(loomInfo.liftplanIndex.value());
+    }
+    if (loomInfo.liftplanLength.has_value()) {
+        json.key("length").value(loomInfo.liftplanLength.value());
+    }
+    if (pick.has_value()) {
+        char value[5];
+        snprintf(value, sizeof(value), "0x%02x", pick.value());
+        json.key("pick").value(value);
+    }
+    json.key("shafts_error").value(shaftsError);
+    json.endObject();
+    if (!json.finish()) {
+        ESP_LOGW(kTag, "Loom status does not fit into an event");
+        return;
+    }
+    mEventStream.publish(event);
+}
@@ -0,0 +1,53 @@
+#include "alloc_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using hla::test::AllocStats;
+
+static std::atomic<size_t> gAllocations{0};
+static std::atomic<size_t> gBytes{0};
+static std::atomic<size_t> gPeakBytes{0};
+
+// the size is stored in front of every block, so delete knows what it frees
+static constexpr size_t kHeaderSize = alignof(std::max_align_t);
+
+static void* allocate(size_t size) {
+    void* block = std::malloc(size + kHeaderSize);
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    *static_cast<size_t*>(block) = size;
+    ++gAllocations;
+    size_t bytes = gBytes += size;
+    size_t peak = gPeakBytes;
+    while (bytes > peak && !gPeakBytes.compare_exchange_weak(peak, bytes)) {
+    }
+    return static_cast<char*>(block) + kHeaderSize;
+}
+
+static void release(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    void* block = static_cast<char*>(ptr) - kHeaderSize;
+    gBytes -= *static_cast<size_t*>(block);
+    std::free(block);
+}
+
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void operator delete(void* ptr) noexcept { release(ptr); }
+void operator delete[](void* ptr) noexcept { release(ptr); }
+void operator delete(void* ptr, size_t) noexcept { release(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { release(ptr); }
+
+AllocStats hla::test::allocStats() {
+    return {gAllocations, gBytes, gPeakBytes};
+}
+
+void hla::test::resetAllocStats() {
+    gAllocations = 0;
+    gPeakBytes = gBytes.load();
+}
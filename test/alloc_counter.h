@@ -0,0 +1,30 @@
+#ifndef alloc_counter_h
+#define alloc_counter_h
+
+#include <cstddef>
+
+namespace hla::test {
+/**
+ * @brief Counters of the global operator new and delete
+ *
+ * Linking alloc_counter.cpp replaces the global allocation functions, so all
+ * heap allocations of the program are counted, including those of the
+ * standard library.
+ */
+struct AllocStats {
+    size_t allocations;   // number of allocations
+    size_t bytes;         // bytes currently allocated
+    size_t peakBytes;     // maximum of bytes since the last reset
+};
+
+/**
+ * @brief Get the allocation counters
+ */
+AllocStats allocStats();
+
+/**
+ * @brief Reset the number of allocations and the peak to the current usage
+ */
+void resetAllocStats();
+}   // namespace hla::test
+#endif   // alloc_counter_h
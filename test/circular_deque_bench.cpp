@@ -0,0 +1,129 @@
+#include <cstdint>
+#include <cstdio>
+
+#include "alloc_counter.h"
+#include "circular_deque.h"
+#include "host_test.h"
+
+using hla::CircularDeque;
+using hla::test::allocStats;
+using hla::test::measureUs;
+using hla::test::resetAllocStats;
+
+namespace {
+/**
+ * @brief Minimal doubly linked ring with one node per element, the layout of
+ * the CircularDeque before it was backed by a ring buffer
+ */
+template <typename T> class LinkedDeque {
+  public:
+    struct Node {
+        T value;
+        Node* next;
+        Node* prev;
+    };
+
+    ~LinkedDeque() {
+        for (int i = 0; i < mSize; ++i) {
+            Node* next = mHead->next;
+            delete mHead;
+            mHead = next;
+        }
+    }
+
+    void pushBack(T value) {
+        Node* node = new Node{value, nullptr, nullptr};
+        if (!mHead) {
+            node->next = node->prev = node;
+            mHead = node;
+        } else {
+            node->next = mHead;
+            node->prev = mHead->prev;
+            mHead->prev->next = node;
+            mHead->prev = node;
+        }
+        ++mSize;
+    }
+
+    Node* head() const { return mHead; }
+
+  private:
+    Node* mHead = nullptr;
+    int mSize = 0;
+};
+
+struct Result {
+    double fillUs;
+    double walkUs;
+    size_t bytes;
+    size_t allocations;
+    unsigned checksum;
+};
+
+Result benchLinked(int picks, int steps) {
+    Result result = {};
+    resetAllocStats();
+    size_t before = allocStats().bytes;
+    LinkedDeque<uint8_t> deque;
+    result.fillUs = measureUs([&] {
+        for (int i = 0; i < picks; ++i) {
+            deque.pushBack(i * 7);
+        }
+    });
+    result.bytes = allocStats().bytes - before;
+    result.allocations = allocStats().allocations;
+    result.walkUs = measureUs([&] {
+        auto* node = deque.head();
+        for (int i = 0; i < steps; ++i) {
+            result.checksum += node->value;
+            node = i % 4 == 3 ? node->prev : node->next;
+        }
+    });
+    return result;
+}
+
+Result benchRing(int picks, int steps) {
+    Result result = {};
+    resetAllocStats();
+    size_t before = allocStats().bytes;
+    CircularDeque<uint8_t> deque;
+    result.fillUs = measureUs([&] {
+        for (int i = 0; i < picks; ++i) {
+            deque.pushBack(i * 7);
+        }
+    });
+    result.bytes = allocStats().bytes - before;
+    result.allocations = allocStats().allocations;
+    result.walkUs = measureUs([&] {
+        auto cursor = deque.frontCursor();
+        for (int i = 0; i < steps; ++i) {
+            result.checksum += cursor.value();
+            cursor = i % 4 == 3 ? cursor.prev() : cursor.next();
+        }
+    });
+    return result;
+}
+
+void print(const char* name, int picks, const Result& result) {
+    printf("%-8s %7d picks: %8zu bytes (%5.1f per pick) in %6zu "
+           "allocations, fill %8.1f us, walk %8.1f us\n",
+           name, picks, result.bytes,
+           static_cast<double>(result.bytes) / picks, result.allocations,
+           result.fillUs, result.walkUs);
+}
+}   // namespace
+
+int main() {
+    // the walk steps forward three times and back once, like a weaver
+    // correcting a pick
+    for (int picks : {1000, 5000, 50000}) {
+        int steps = picks * 4;
+        Result linked = benchLinked(picks, steps);
+        Result ring = benchRing(picks, steps);
+        print("linked", picks, linked);
+        print("ring", picks, ring);
+        CHECK_EQ(linked.checksum, ring.checksum);
+        CHECK(ring.bytes < linked.bytes);
+    }
+    return hla::test::result();
+}
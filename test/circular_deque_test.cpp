@@ -0,0 +1,171 @@
+#include <cstdint>
+#include <deque>
+
+#include "alloc_counter.h"
+#include "circular_deque.h"
+#include "host_test.h"
+
+using hla::CircularDeque;
+using hla::test::allocStats;
+using hla::test::resetAllocStats;
+
+// compares the container with a reference, through front/back, cursors and
+// both directions of traversal
+static void checkContent(const CircularDeque<int>& deque,
+                         const std::deque<int>& expected) {
+    CHECK_EQ(deque.length(), static_cast<int>(expected.size()));
+    if (expected.empty()) {
+        CHECK(!deque.front().has_value());
+        CHECK(!deque.back().has_value());
+        CHECK(!deque.frontCursor().isValid());
+        CHECK(!deque.backCursor().isValid());
+        return;
+    }
+    CHECK_EQ(deque.front().value(), expected.front());
+    CHECK_EQ(deque.back().value(), expected.back());
+    auto cursor = deque.frontCursor();
+    for (size_t i = 0; i < expected.size(); ++i) {
+        CHECK(cursor.isValid());
+        CHECK_EQ(cursor.index(), static_cast<int>(i));
+        CHECK_EQ(cursor.value(), expected[i]);
+        cursor = cursor.next();
+    }
+    // next() wraps around to the front
+    CHECK_EQ(cursor.index(), 0);
+    cursor = deque.frontCursor().prev();
+    CHECK_EQ(cursor.index(), static_cast<int>(expected.size()) - 1);
+    for (size_t i = expected.size(); i-- > 0;) {
+        CHECK_EQ(cursor.value(), expected[i]);
+        cursor = cursor.prev();
+    }
+}
+
+static void testEmpty() {
+    CircularDeque<int> deque;
+    checkContent(deque, {});
+    CHECK(!deque.cursorAt(0).isValid());
+    deque.popFront();
+    deque.popBack();
+    checkContent(deque, {});
+}
+
+static void testPushAndPop() {
+    CircularDeque<int> deque;
+    std::deque<int> expected;
+    // pushing to both ends wraps the head around and grows several times
+    for (int i = 0; i < 100; ++i) {
+        if (i % 3) {
+            deque.pushBack(i);
+            expected.push_back(i);
+        } else {
+            deque.pushFront(i);
+            expected.push_front(i);
+        }
+    }
+    checkContent(deque, expected);
+    for (int i = 0; i < 30; ++i) {
+        deque.popFront();
+        expected.pop_front();
+        deque.popBack();
+        expected.pop_back();
+    }
+    checkContent(deque, expected);
+    // refill after the head moved
+    for (int i = 0; i < 50; ++i) {
+        deque.pushFront(-i);
+        expected.push_front(-i);
+    }
+    checkContent(deque, expected);
+}
+
+static void testCursor() {
+    CircularDeque<int> deque;
+    for (int i = 0; i < 5; ++i) {
+        deque.pushBack(i * 10);
+    }
+    CHECK_EQ(deque.cursorAt(3).value(), 30);
+    CHECK(!deque.cursorAt(-1).isValid());
+    CHECK(!deque.cursorAt(5).isValid());
+    auto cursor = deque.backCursor();
+    CHECK_EQ(cursor.next().value(), 0);
+    cursor.reset();
+    CHECK(!cursor.isValid());
+    CHECK(!cursor.next().isValid());
+    CHECK(!cursor.prev().isValid());
+    // a single element is its own neighbour
+    CircularDeque<int> single;
+    single.pushBack(7);
+    CHECK_EQ(single.frontCursor().next().value(), 7);
+    CHECK_EQ(single.frontCursor().prev().value(), 7);
+}
+
+static void testCopy() {
+    CircularDeque<int> deque;
+    std::deque<int> expected;
+    for (int i = 0; i < 20; ++i) {
+        deque.pushFront(i);
+        expected.push_front(i);
+    }
+    CircularDeque<int> copy(deque);
+    checkContent(copy, expected);
+    CircularDeque<int> assigned;
+    assigned.pushBack(1);
+    assigned = deque;
+    checkContent(assigned, expected);
+    // the copies are independent
+    deque.popBack();
+    checkContent(copy, expected);
+    assigned = assigned;
+    checkContent(assigned, expected);
+    CircularDeque<int> empty;
+    assigned = empty;
+    checkContent(assigned, {});
+}
+
+static void testEmptyReleasesStorage() {
+    CircularDeque<int> deque;
+    for (int i = 0; i < 10; ++i) {
+        deque.pushBack(i);
+    }
+    deque.empty();
+    checkContent(deque, {});
+    deque.pushBack(3);
+    checkContent(deque, {3});
+}
+
+static void testStorage() {
+    // one allocation of one byte per pick once the size is known
+    resetAllocStats();
+    size_t before = allocStats().bytes;
+    {
+        CircularDeque<uint8_t> deque;
+        deque.reserve(5000);
+        for (int i = 0; i < 5000; ++i) {
+            deque.pushBack(i & 0xff);
+        }
+        CHECK_EQ(allocStats().allocations, 1u);
+        CHECK_EQ(allocStats().bytes - before, 5000u);
+        CHECK_EQ(deque.cursorAt(4999).value(), 4999 & 0xff);
+    }
+    CHECK_EQ(allocStats().bytes, before);
+    // growing by doubling allocates a logarithmic number of times
+    resetAllocStats();
+    {
+        CircularDeque<uint8_t> deque;
+        for (int i = 0; i < 5000; ++i) {
+            deque.pushBack(i & 0xff);
+        }
+        CHECK(allocStats().allocations <= 10u);
+    }
+    CHECK_EQ(allocStats().bytes, before);
+}
+
+int main() {
+    testEmpty();
+    testPushAndPop();
+    testCursor();
+    testCopy();
+    testEmptyReleasesStorage();
+    testStorage();
+    return hla::test::result();
+}
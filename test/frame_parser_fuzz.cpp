@@ -0,0 +1,255 @@
+// Fuzz and benchmark harness of the FrameParser.
+//
+// LLVMFuzzerTestOneInput() checks the invariants of the parser on arbitrary
+// input, it is run by libFuzzer when built with HLA_LIBFUZZER=ON. Otherwise
+// main() feeds it random streams with a fixed seed, then measures how fast the
+// parser recovers from lost, extra and flipped bytes in a stream of frames.
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "frame_parser.h"
+#include "host_test.h"
+
+using hla::FrameParser;
+using hla::test::measureUs;
+
+namespace {
+using Frame = FrameParser::Frame;
+
+bool sameFrame(const Frame& a, const Frame& b) {
+    return a.cmd == b.cmd && a.seq == b.seq && a.data == b.data;
+}
+
+std::vector<Frame> parse(const uint8_t* data, size_t size, size_t chunk) {
+    std::vector<Frame> frames;
+    FrameParser parser([&frames](const Frame& frame) {
+        frames.push_back(frame);
+    });
+    for (size_t i = 0; i < size; i += chunk) {
+        parser.feed(data + i, std::min(chunk, size - i));
+    }
+    return frames;
+}
+
+bool contains(const uint8_t* data, size_t size, const uint8_t* frame) {
+    if (size < FrameParser::kFrameSize) {
+        return false;
+    }
+    for (size_t i = 0; i <= size - FrameParser::kFrameSize; ++i) {
+        if (!memcmp(data + i, frame, FrameParser::kFrameSize)) {
+            return true;
+        }
+    }
+    return false;
+}
+}   // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    // the first byte picks the chunk size the bytes are fed with
+    if (size == 0) {
+        return 0;
+    }
+    const size_t chunk = data[0] % 16 + 1;
+    ++data;
+    --size;
+    auto frames = parse(data, size, chunk);
+    // the frames do not depend on how the bytes were split
+    auto whole = parse(data, size, size ? size : 1);
+    CHECK(frames.size() == whole.size() &&
+          std::equal(frames.begin(), frames.end(), whole.begin(), sameFrame));
+    for (const auto& frame : frames) {
+        // every frame was received as is, with a valid CRC
+        uint8_t encoded[FrameParser::kFrameSize];
+        FrameParser::encode(frame, encoded);
+        CHECK(contains(data, size, encoded));
+    }
+    CHECK(frames.size() <= size / FrameParser::kFrameSize);
+#ifdef HLA_LIBFUZZER
+    if (hla::test::gFailures) {
+        abort();   // libFuzzer only keeps the inputs that crash
+    }
+#endif
+    return 0;
+}
+
+#ifndef HLA_LIBFUZZER
+namespace {
+enum class Corruption { Drop, Insert, Flip };
+
+struct Recovery {
+    int events = 0;
+    int lostFrames = 0;
+    int maxLostFrames = 0;
+    int phantomFrames = 0;
+    size_t bytes = 0;      // from a corruption to the next decoded frame
+    size_t maxBytes = 0;
+};
+
+// protocol commands, a stream of frames looks like the traffic of the slider
+constexpr uint8_t kCommands[] = {0x10, 0x11, 0x12, 0x13, 0x20, 0x21,
+                                 0x30, 0x32, 0x40, 0x41, 0x50, 0x51};
+
+void fuzzRandom(std::mt19937& rng, int runs) {
+    std::vector<uint8_t> input;
+    for (int run = 0; run < runs; ++run) {
+        input.resize(rng() % 64);
+        for (auto& byte : input) {
+            // plenty of markers, so that frames start everywhere
+            byte = rng() % 4 ? rng() : FrameParser::kStartOfFrame;
+        }
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+}
+
+// valid frames with some bytes corrupted, mutated the way libFuzzer would
+void fuzzFrames(std::mt19937& rng, int runs) {
+    std::vector<uint8_t> input;
+    for (int run = 0; run < runs; ++run) {
+        input.assign(1, rng());
+        int frames = rng() % 8;
+        for (int i = 0; i < frames; ++i) {
+            uint8_t buf[FrameParser::kFrameSize];
+            FrameParser::encode({kCommands[rng() % sizeof(kCommands)],
+                                 static_cast<uint8_t>(i),
+                                 static_cast<uint8_t>(rng())},
+                                buf);
+            input.insert(input.end(), buf, buf + sizeof(buf));
+        }
+        int mutations = rng() % 4;
+        for (int i = 0; i < mutations && input.size() > 1; ++i) {
+            size_t pos = 1 + rng() % (input.size() - 1);
+            input[pos] ^= 1 << (rng() % 8);
+        }
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+}
+
+// a stream of frames with one corruption after every few clean frames, the
+// decoded frames are matched against the sent ones to find which were lost
+Recovery measureRecovery(std::mt19937& rng, Corruption corruption,
+                         int events) {
+    constexpr int kCleanFrames = 4;
+    std::vector<Frame> sent;
+    std::vector<uint8_t> stream;
+    std::vector<size_t> corruptedAt;   // stream offsets of the corruptions
+    for (int event = 0; event < events; ++event) {
+        for (int i = 0; i < kCleanFrames; ++i) {
+            Frame frame = {kCommands[rng() % sizeof(kCommands)],
+                           static_cast<uint8_t>(sent.size()),
+                           static_cast<uint8_t>(rng())};
+            sent.push_back(frame);
+            uint8_t buf[FrameParser::kFrameSize];
+            FrameParser::encode(frame, buf);
+            stream.insert(stream.end(), buf, buf + sizeof(buf));
+        }
+        // corrupt the last frame
+        size_t pos = stream.size() - 1 - rng() % FrameParser::kFrameSize;
+        corruptedAt.push_back(pos);
+        switch (corruption) {
+        case Corruption::Drop:
+            stream.erase(stream.begin() + pos);
+            break;
+        case Corruption::Insert:
+            stream.insert(stream.begin() + pos, static_cast<uint8_t>(rng()));
+            break;
+        case Corruption::Flip:
+            stream[pos] ^= 1 << (rng() % 8);
+            break;
+        }
+    }
+
+    Recovery recovery;
+    size_t offset = 0;
+    size_t next = 0;   // index of the next expected sent frame
+    size_t event = 0;
+    int lost = 0;
+    auto finishEvent = [&](size_t decodedAt) {
+        size_t bytes = decodedAt - corruptedAt[event];
+        recovery.bytes += bytes;
+        recovery.maxBytes = std::max(recovery.maxBytes, bytes);
+        recovery.lostFrames += lost;
+        recovery.maxLostFrames = std::max(recovery.maxLostFrames, lost);
+        lost = 0;
+        ++event;
+        ++recovery.events;
+    };
+    FrameParser parser([&](const Frame& frame) {
+        // a frame may only be missing around a corruption, look a few ahead
+        size_t match = next;
+        while (match < sent.size() && match < next + kCleanFrames + 1 &&
+               !sameFrame(sent[match], frame)) {
+            ++match;
+        }
+        if (match == sent.size() || !sameFrame(sent[match], frame)) {
+            ++recovery.phantomFrames;
+            return;
+        }
+        lost += match - next;
+        next = match + 1;
+        if (event < corruptedAt.size() && offset > corruptedAt[event]) {
+            finishEvent(offset);
+        }
+    });
+    for (; offset < stream.size(); ++offset) {
+        parser.feed(&stream[offset], 1);
+    }
+    // every corruption but the one at the end of the stream was recovered from
+    CHECK(event + 1 >= corruptedAt.size());
+    return recovery;
+}
+
+void reportRecovery(const char* name, const Recovery& recovery) {
+    // 10 bits per byte on the wire
+    double meanBytes = static_cast<double>(recovery.bytes) / recovery.events;
+    printf("%-7s %5d events: frames lost mean %.2f max %d, phantom frames %d, "
+           "recovery bytes mean %.1f max %zu (%.2f ms at 9600 baud)\n",
+           name, recovery.events,
+           static_cast<double>(recovery.lostFrames) / recovery.events,
+           recovery.maxLostFrames, recovery.phantomFrames, meanBytes,
+           recovery.maxBytes, meanBytes * 10 * 1000 / 9600);
+    // only the corrupted frame is lost unless a phantom frame overlaps the
+    // next one
+    CHECK(recovery.lostFrames <= recovery.events + recovery.phantomFrames);
+    CHECK(recovery.maxLostFrames <= 2);
+}
+
+void benchThroughput(std::mt19937& rng) {
+    std::vector<uint8_t> stream;
+    for (int i = 0; i < 100000; ++i) {
+        uint8_t buf[FrameParser::kFrameSize];
+        FrameParser::encode({kCommands[rng() % sizeof(kCommands)],
+                             static_cast<uint8_t>(i),
+                             static_cast<uint8_t>(rng())},
+                            buf);
+        stream.insert(stream.end(), buf, buf + sizeof(buf));
+    }
+    int frames = 0;
+    FrameParser parser([&frames](const Frame&) { ++frames; });
+    double us = measureUs([&] {
+        // chunks of the size of the UART driver's rx events
+        for (size_t i = 0; i < stream.size(); i += 120) {
+            parser.feed(&stream[i], std::min<size_t>(120, stream.size() - i));
+        }
+    });
+    CHECK_EQ(frames, 100000);
+    printf("throughput: %.1f MB/s, %.1f ns/frame\n", stream.size() / us,
+           us * 1000 / frames);
+}
+}   // namespace
+
+int main() {
+    std::mt19937 rng(0x5eed);
+    fuzzRandom(rng, 100000);
+    fuzzFrames(rng, 100000);
+    reportRecovery("drop", measureRecovery(rng, Corruption::Drop, 10000));
+    reportRecovery("insert", measureRecovery(rng, Corruption::Insert, 10000));
+    reportRecovery("flip", measureRecovery(rng, Corruption::Flip, 10000));
+    benchThroughput(rng);
+    return hla::test::result();
+}
+#endif   // HLA_LIBFUZZER
@@ -0,0 +1,55 @@
+#ifndef host_test_h
+#define host_test_h
+
+#include <chrono>
+#include <cstdio>
+
+namespace hla::test {
+inline int gFailures = 0;
+
+/**
+ * @brief Return the exit code of a test, reporting the number of failures
+ */
+inline int result() {
+    if (gFailures) {
+        fprintf(stderr, "%d check(s) failed\n", gFailures);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Measure the time a function takes
+ * @return elapsed time in microseconds
+ */
+template <typename F> double measureUs(F&& function) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count();
+}
+}   // namespace hla::test
+
+#define CHECK(cond)                                                            \
+    do {                                                                       \
+        if (!(cond)) {                                                         \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__,   \
+                    #cond);                                                    \
+            ++hla::test::gFailures;                                            \
+        }                                                                      \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                         \
+    do {                                                                       \
+        auto valueA = (a);                                                     \
+        auto valueB = (b);                                                     \
+        if (!(valueA == valueB)) {                                             \
+            fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n",  \
+                    __FILE__, __LINE__, #a, #b,                                \
+                    static_cast<long long>(valueA),                            \
+                    static_cast<long long>(valueB));                           \
+            ++hla::test::gFailures;                                            \
+        }                                                                      \
+    } while (0)
+
+#endif   // host_test_h
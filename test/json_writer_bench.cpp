@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+#include "alloc_counter.h"
+#include "host_test.h"
+#include "json_writer.h"
+
+#ifdef HLA_HAVE_CJSON
+#include <cjson/cJSON.h>
+#endif
+
+using hla::JsonWriter;
+using hla::test::allocStats;
+using hla::test::measureUs;
+using hla::test::resetAllocStats;
+
+static constexpr int kDocuments = 100000;
+
+namespace {
+struct Result {
+    double us;
+    size_t allocations;
+    size_t peakBytes;
+    size_t length;
+};
+
+void report(const char* name, const char* document, const Result& result) {
+    printf("%-10s %-7s %7.1f ns/doc, %5.2f allocations/doc, peak %4zu bytes, "
+           "%3zu bytes long\n",
+           name, document, result.us * 1000 / kDocuments,
+           static_cast<double>(result.allocations) / kDocuments,
+           result.peakBytes, result.length);
+}
+
+// Writes a document kDocuments times the way the handlers of the web server
+// do: into a buffer on the stack, passed to the response at the end
+template <typename Write> Result benchWriter(const Write& write) {
+    Result result = {};
+    char response[512];
+    resetAllocStats();
+    result.us = measureUs([&] {
+        for (int i = 0; i < kDocuments; ++i) {
+            char buffer[128];
+            JsonWriter json(buffer, sizeof(buffer),
+                            [&](const char* data, size_t len, bool last) {
+                                memcpy(response, data, len);
+                                result.length = len;
+                                return last;
+                            });
+            write(json, i);
+            CHECK(json.finish());
+        }
+    });
+    result.allocations = allocStats().allocations;
+    result.peakBytes = allocStats().peakBytes - allocStats().bytes;
+    return result;
+}
+
+void writeIndex(JsonWriter& json, int i) {
+    json.beginObject().key("index").value(i).endObject();
+}
+
+void writeStatus(JsonWriter& json, int i) {
+    json.beginObject()
+        .key("loom_state")
+        .value("running")
+        .key("active_liftplan")
+        .value("twill_herringbone.json")
+        .key("index")
+        .value(i)
+        .key("length")
+        .value(1200)
+        .endObject();
+}
+
+#ifdef HLA_HAVE_CJSON
+// cJSON allocates with malloc, routed through the counted operator new
+void* countedMalloc(size_t size) { return ::operator new(size); }
+void countedFree(void* ptr) { ::operator delete(ptr); }
+
+// the path of the handlers before the writer: a tree, printed with
+// formatting into a second heap string, both freed after sending
+template <typename Build> Result benchCJson(const Build& build) {
+    cJSON_Hooks hooks = {countedMalloc, countedFree};
+    cJSON_InitHooks(&hooks);
+    Result result = {};
+    char response[512];
+    resetAllocStats();
+    result.us = measureUs([&] {
+        for (int i = 0; i < kDocuments; ++i) {
+            cJSON* root = build(i);
+            char* str = cJSON_Print(root);
+            result.length = strlen(str);
+            memcpy(response, str, std::min(result.length, sizeof(response)));
+            cJSON_free(str);
+            cJSON_Delete(root);
+        }
+    });
+    result.allocations = allocStats().allocations;
+    result.peakBytes = allocStats().peakBytes - allocStats().bytes;
+    cJSON_InitHooks(nullptr);
+    return result;
+}
+
+cJSON* buildIndex(int i) {
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddNumberToObject(root, "index", i);
+    return root;
+}
+
+cJSON* buildStatus(int i) {
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "loom_state", "running");
+    cJSON_AddStringToObject(root, "active_liftplan",
+                            "twill_herringbone.json");
+    cJSON_AddNumberToObject(root, "index", i);
+    cJSON_AddNumberToObject(root, "length", 1200);
+    return root;
+}
+#endif
+}   // namespace
+
+int main() {
+    auto index = benchWriter(writeIndex);
+    auto status = benchWriter(writeStatus);
+    report("JsonWriter", "index", index);
+    report("JsonWriter", "status", status);
+    CHECK_EQ(index.allocations, 0u);
+    CHECK_EQ(status.allocations, 0u);
+#ifdef HLA_HAVE_CJSON
+    report("cJSON", "index", benchCJson(buildIndex));
+    report("cJSON", "status", benchCJson(buildStatus));
+#else
+    printf("cJSON not found, comparison skipped\n");
+#endif
+    return hla::test::result();
+}
@@ -0,0 +1,202 @@
+#include <cstring>
+#include <string>
+
+#include "alloc_counter.h"
+#include "host_test.h"
+#include "json_writer.h"
+
+using hla::JsonWriter;
+using hla::test::allocStats;
+using hla::test::resetAllocStats;
+
+namespace {
+// collects the pieces passed to the sink
+struct Output {
+    std::string document;
+    int pieces = 0;
+    bool last = false;
+};
+
+JsonWriter::Sink collect(Output& output) {
+    return [&output](const char* data, size_t len, bool last) {
+        output.document.append(data, len);
+        ++output.pieces;
+        output.last = last;
+        return true;
+    };
+}
+
+void checkDocument(const Output& output, const char* expected) {
+    CHECK(output.last);
+    if (output.document != expected) {
+        fprintf(stderr, "expected %s\n     got %s\n", expected,
+                output.document.c_str());
+        ++hla::test::gFailures;
+    }
+}
+
+void testValues() {
+    char buffer[256];
+    Output output;
+    JsonWriter json(buffer, sizeof(buffer), collect(output));
+    json.beginObject()
+        .key("s")
+        .value("text")
+        .key("std")
+        .value(std::string("string"))
+        .key("t")
+        .value(true)
+        .key("f")
+        .value(false)
+        .key("i")
+        .value(-2147483647 - 1)
+        .key("u")
+        .value(4294967295u)
+        .endObject();
+    CHECK(json.finish());
+    CHECK_EQ(output.pieces, 1);
+    checkDocument(output, "{\"s\":\"text\",\"std\":\"string\",\"t\":true,"
+                          "\"f\":false,\"i\":-2147483648,\"u\":4294967295}");
+}
+
+void testNesting() {
+    char buffer[256];
+    Output output;
+    JsonWriter json(buffer, sizeof(buffer), collect(output));
+    json.beginArray()
+        .beginObject()
+        .endObject()
+        .beginArray()
+        .endArray()
+        .beginObject()
+        .key("a")
+        .beginArray()
+        .value(1)
+        .value(2)
+        .endArray()
+        .key("o")
+        .beginObject()
+        .key("x")
+        .value(0)
+        .endObject()
+        .endObject()
+        .value("last")
+        .endArray();
+    CHECK(json.finish());
+    checkDocument(output, "[{},[],{\"a\":[1,2],\"o\":{\"x\":0}},\"last\"]");
+}
+
+void testEscaping() {
+    char buffer[256];
+    Output output;
+    JsonWriter json(buffer, sizeof(buffer), collect(output));
+    json.beginObject().key("k\"ey").value("q\" b\\ n\n r\r t\t \x01\x1f é");
+    json.endObject();
+    CHECK(json.finish());
+    checkDocument(output, "{\"k\\\"ey\":\"q\\\" b\\\\ n\\n r\\r t\\t "
+                          "\\u0001\\u001f é\"}");
+}
+
+// a document larger than the buffer is passed on in pieces of its size
+void testChunks() {
+    char buffer[7];
+    Output output;
+    JsonWriter json(buffer, sizeof(buffer), collect(output));
+    std::string expected = "[";
+    json.beginArray();
+    for (int i = 0; i < 100; ++i) {
+        json.value(i);
+        expected += (i ? "," : "") + std::to_string(i);
+    }
+    json.endArray();
+    expected += "]";
+    CHECK(json.finish());
+    CHECK_EQ(output.pieces,
+             static_cast<int>((expected.size() + sizeof(buffer) - 1) /
+                              sizeof(buffer)));
+    checkDocument(output, expected.c_str());
+}
+
+void testErrors() {
+    char buffer[64];
+    Output output;
+    {
+        // an unfinished document is not passed on as complete
+        JsonWriter json(buffer, sizeof(buffer), collect(output));
+        json.beginObject().key("a");
+        CHECK(!json.finish());
+        CHECK(!output.last);
+    }
+    {
+        JsonWriter json(buffer, sizeof(buffer), collect(output));
+        json.endArray();
+        CHECK(!json.finish());
+    }
+    {
+        JsonWriter json(buffer, sizeof(buffer), collect(output));
+        for (int i = 0; i < 33; ++i) {
+            json.beginArray();
+        }
+        for (int i = 0; i < 33; ++i) {
+            json.endArray();
+        }
+        CHECK(!json.finish());
+    }
+    {
+        // a sink that fails stops the document, the way publishLoomStatus()
+        // refuses events larger than its buffer
+        int calls = 0;
+        JsonWriter json(buffer, 4, [&calls](const char*, size_t, bool last) {
+            ++calls;
+            return last;
+        });
+        json.beginObject().key("long").value("value").endObject();
+        CHECK(!json.finish());
+        CHECK_EQ(calls, 1);
+    }
+}
+
+// the documents of the status polls and the loom events do not allocate
+void testNoAllocation() {
+    char buffer[128];
+    char event[128];
+    size_t eventLength = 0;
+    resetAllocStats();
+    for (unsigned int i = 0; i < 1000; ++i) {
+        JsonWriter json(buffer, sizeof(buffer),
+                        [&event, &eventLength](const char* data, size_t len,
+                                               bool last) {
+                            memcpy(event, data, len);
+                            eventLength = len;
+                            return last;
+                        });
+        json.beginObject()
+            .key("loom_state")
+            .value("running")
+            .key("active_liftplan")
+            .value("twill.json")
+            .key("index")
+            .value(i)
+            .key("length")
+            .value(1200u)
+            .key("pick")
+            .value("0x5a")
+            .key("shafts_error")
+            .value(false)
+            .endObject();
+        CHECK(json.finish());
+    }
+    CHECK_EQ(allocStats().allocations, 0u);
+    CHECK(eventLength > 0);
+}
+}   // namespace
+
+int main() {
+    testValues();
+    testNesting();
+    testEscaping();
+    testChunks();
+    testErrors();
+    testNoAllocation();
+    return hla::test::result();
+}
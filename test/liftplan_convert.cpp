@@ -0,0 +1,71 @@
+// Converts a JSON liftplan to the binary format the firmware plays back, the
+// same conversion ConfigStore::saveLiftPlan() does on upload, and prints a
+// binary liftplan as JSON again.
+//
+// Usage: liftplan_convert <liftplan.json> <liftplan.bin>
+//        liftplan_convert --dump <liftplan.bin>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "liftplan.h"
+#include "liftplan_parser.h"
+
+using hla::Liftplan;
+using hla::LiftplanParser;
+using hla::LiftplanWriter;
+
+static int convert(const char* input, const char* output) {
+    std::ifstream file(input, std::ios::binary);
+    if (!file.is_open()) {
+        fprintf(stderr, "Cannot open %s\n", input);
+        return 1;
+    }
+    LiftplanWriter writer;
+    if (!writer.open(output)) {
+        fprintf(stderr, "Cannot create %s\n", output);
+        return 1;
+    }
+    LiftplanParser parser([&writer](uint8_t pick) { writer.write(pick); });
+    char chunk[256];
+    bool valid = true;
+    while (valid && (file.read(chunk, sizeof(chunk)) || file.gcount() > 0)) {
+        valid = parser.feed(chunk, file.gcount());
+    }
+    if (!writer.close() || !valid || !parser.isComplete()) {
+        fprintf(stderr, "%s is not a valid liftplan\n", input);
+        remove(output);
+        return 1;
+    }
+    printf("%s: %u picks\n", output, parser.count());
+    return 0;
+}
+
+static int dump(const char* input) {
+    Liftplan liftplan;
+    if (!liftplan.open(input)) {
+        fprintf(stderr, "%s is not a valid binary liftplan\n", input);
+        return 1;
+    }
+    printf("[");
+    for (int i = 0; i < liftplan.length(); ++i) {
+        printf("%s\"0x%02x\"", i ? ", " : "", liftplan.at(i));
+    }
+    printf("]\n");
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 3 && strcmp(argv[1], "--dump") == 0) {
+        return dump(argv[2]);
+    }
+    if (argc == 3) {
+        return convert(argv[1], argv[2]);
+    }
+    fprintf(stderr,
+            "Usage: %s <liftplan.json> <liftplan.bin>\n"
+            "       %s --dump <liftplan.bin>\n",
+            argv[0], argv[0]);
+    return 2;
+}
@@ -0,0 +1,87 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "alloc_counter.h"
+#include "circular_deque.h"
+#include "host_test.h"
+#include "liftplan_parser.h"
+
+using hla::CircularDeque;
+using hla::LiftplanParser;
+using hla::test::allocStats;
+using hla::test::measureUs;
+using hla::test::resetAllocStats;
+
+// chunk size of ConfigStore::loadLiftplan()
+static constexpr size_t kReadChunkSize = 256;
+
+static void writeLiftplan(const std::filesystem::path& path, int picks) {
+    std::ofstream file(path, std::ios::binary);
+    file << "[";
+    for (int i = 0; i < picks; ++i) {
+        char value[16];
+        snprintf(value, sizeof(value), "%s\"0x%02x\"", i ? ", " : "",
+                 (i * 37) & 0xff);
+        file << value;
+    }
+    file << "]";
+}
+
+// the picks go straight from the file chunks into the deque
+static void benchStreaming(const std::filesystem::path& path, int picks) {
+    resetAllocStats();
+    size_t before = allocStats().bytes;
+    bool ok = false;
+    int count = 0;
+    double us = measureUs([&] {
+        CircularDeque<uint8_t> deque;
+        LiftplanParser parser([&deque](uint8_t pick) { deque.pushBack(pick); });
+        std::ifstream file(path, std::ios::binary);
+        char chunk[kReadChunkSize];
+        ok = true;
+        while (ok && (file.read(chunk, sizeof(chunk)) || file.gcount() > 0)) {
+            ok = parser.feed(chunk, file.gcount());
+        }
+        ok = ok && parser.isComplete();
+        count = deque.length();
+    });
+    CHECK(ok);
+    CHECK_EQ(count, picks);
+    printf("%7d picks, streaming:      peak heap %8zu bytes, %9.1f us\n",
+           picks, allocStats().peakBytes - before, us);
+}
+
+// the first step of the former loader: the whole file in a string, before
+// any JSON tree is built
+static void benchWholeFile(const std::filesystem::path& path, int picks) {
+    resetAllocStats();
+    size_t before = allocStats().bytes;
+    size_t size = 0;
+    double us = measureUs([&] {
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        std::string content = buffer.str();
+        size = content.size();
+    });
+    CHECK(size == std::filesystem::file_size(path));
+    printf("%7d picks, whole file:     peak heap %8zu bytes, %9.1f us "
+           "(file %zu bytes, without the cJSON tree)\n",
+           picks, allocStats().peakBytes - before, us, size);
+}
+
+int main() {
+    auto dir = std::filesystem::temp_directory_path() / "hla_parser_bench";
+    std::filesystem::create_directories(dir);
+    for (int picks : {1000, 10000, 100000}) {
+        auto path = dir / ("liftplan_" + std::to_string(picks) + ".json");
+        writeLiftplan(path, picks);
+        benchStreaming(path, picks);
+        benchWholeFile(path, picks);
+    }
+    std::filesystem::remove_all(dir);
+    return hla::test::result();
+}
@@ -0,0 +1,109 @@
+#include <string>
+#include <vector>
+
+#include "host_test.h"
+#include "liftplan_parser.h"
+
+using hla::LiftplanParser;
+
+struct ParseResult {
+    bool valid;      // no feed() failed
+    bool complete;   // the closing bracket was reached
+    std::vector<uint8_t> picks;
+};
+
+// feeds the input in chunks of a given size
+static ParseResult parse(const std::string& input, size_t chunkSize) {
+    ParseResult result = {true, false, {}};
+    LiftplanParser parser([&result](uint8_t pick) {
+        result.picks.push_back(pick);
+    });
+    for (size_t pos = 0; pos < input.size() && result.valid;
+         pos += chunkSize) {
+        result.valid = parser.feed(input.data() + pos,
+                                   std::min(chunkSize, input.size() - pos));
+    }
+    result.complete = parser.isComplete();
+    CHECK_EQ(parser.count(), result.picks.size());
+    return result;
+}
+
+static void checkValid(const std::string& input,
+                       const std::vector<uint8_t>& expected) {
+    // every chunk size gives the same result, including one byte at a time
+    for (size_t chunkSize = 1; chunkSize <= input.size(); ++chunkSize) {
+        ParseResult result = parse(input, chunkSize);
+        CHECK(result.valid);
+        CHECK(result.complete);
+        CHECK(result.picks == expected);
+    }
+}
+
+static void checkInvalid(const std::string& input) {
+    for (size_t chunkSize = 1; chunkSize <= input.size(); ++chunkSize) {
+        ParseResult result = parse(input, chunkSize);
+        CHECK(!result.valid);
+        CHECK(!result.complete);
+    }
+}
+
+static void testValid() {
+    checkValid("[]", {});
+    checkValid("[\"0x01\"]", {0x01});
+    checkValid("[\"0x01\",\"0x03\",\"0xff\",\"0x00\"]",
+               {0x01, 0x03, 0xff, 0x00});
+    checkValid(" \n[ \"0x0a\" ,\r\n\t\"0xA0\" ] \n", {0x0a, 0xa0});
+    // the prefix is optional
+    checkValid("[\"ff\", \"7\"]", {0xff, 0x07});
+}
+
+static void testIncomplete() {
+    ParseResult result = parse("[\"0x01\", \"0x02\"", 4);
+    CHECK(result.valid);
+    CHECK(!result.complete);
+    CHECK_EQ(result.picks.size(), 2u);
+    result = parse("", 1);
+    CHECK(!result.complete);
+}
+
+static void testInvalid() {
+    checkInvalid("{}");
+    checkInvalid("\"0x01\"");
+    checkInvalid("[0x01]");
+    checkInvalid("[\"0x01\" \"0x02\"]");
+    checkInvalid("[\"0x01\",]");
+    checkInvalid("[,\"0x01\"]");
+    checkInvalid("[\"\"]");
+    checkInvalid("[\"zz\"]");
+    checkInvalid("[\"0x100\"]");
+    checkInvalid("[\"0x0001\"]");
+    checkInvalid("[\"0x01\"] x");
+    checkInvalid("[\"0x01\"]]");
+}
+
+static void testPicksBeforeError() {
+    // picks are emitted as they are parsed, the caller discards them on error
+    ParseResult result = parse("[\"0x01\", \"0x02\", \"bad\"]", 64);
+    CHECK(!result.valid);
+    CHECK_EQ(result.picks.size(), 2u);
+}
+
+static void testReset() {
+    std::vector<uint8_t> picks;
+    LiftplanParser parser([&picks](uint8_t pick) { picks.push_back(pick); });
+    CHECK(!parser.feed("x", 1));
+    parser.reset();
+    CHECK(parser.feed("[\"0x05\"]", 8));
+    CHECK(parser.isComplete());
+    CHECK_EQ(parser.count(), 1u);
+    CHECK(picks == std::vector<uint8_t>{0x05});
+}
+
+int main() {
+    testValid();
+    testIncomplete();
+    testInvalid();
+    testPicksBeforeError();
+    testReset();
+    return hla::test::result();
+}
@@ -0,0 +1,43 @@
+# Converts a liftplan to the binary format and back with liftplan_convert and
+# checks that the picks survive the round trip.
+#
+# Usage: cmake -DCONVERT=<liftplan_convert> -DWORK_DIR=<dir> -P <this file>
+
+file(REMOVE_RECURSE ${WORK_DIR})
+file(MAKE_DIRECTORY ${WORK_DIR})
+
+# more than a page of the playback cache, every pick value once
+set(picks "")
+foreach(i RANGE 0 599)
+    math(EXPR value "(${i} * 37) % 256" OUTPUT_FORMAT HEXADECIMAL)
+    string(SUBSTRING "${value}" 2 -1 digits)
+    string(LENGTH "${digits}" length)
+    if(length EQUAL 1)
+        set(digits "0${digits}")
+    endif()
+    list(APPEND picks "\"0x${digits}\"")
+endforeach()
+list(JOIN picks ", " picks)
+set(liftplan "[${picks}]\n")
+file(WRITE ${WORK_DIR}/liftplan.json "${liftplan}")
+
+execute_process(COMMAND ${CONVERT} ${WORK_DIR}/liftplan.json
+                        ${WORK_DIR}/liftplan.bin
+                RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Conversion failed")
+endif()
+execute_process(COMMAND ${CONVERT} --dump ${WORK_DIR}/liftplan.bin
+                OUTPUT_VARIABLE dumped RESULT_VARIABLE result)
+if(NOT result EQUAL 0 OR NOT dumped STREQUAL liftplan)
+    message(FATAL_ERROR "Round trip changed the liftplan")
+endif()
+
+# an invalid liftplan leaves no binary behind
+file(WRITE ${WORK_DIR}/invalid.json "[\"0x01\", \"zz\"]")
+execute_process(COMMAND ${CONVERT} ${WORK_DIR}/invalid.json
+                        ${WORK_DIR}/invalid.bin
+                RESULT_VARIABLE result ERROR_QUIET)
+if(result EQUAL 0 OR EXISTS ${WORK_DIR}/invalid.bin)
+    message(FATAL_ERROR "Invalid liftplan was converted")
+endif()
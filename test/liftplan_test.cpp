@@ -0,0 +1,190 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "esp_rom_crc.h"
+#include "host_test.h"
+#include "liftplan.h"
+#include "liftplan_parser.h"
+
+using hla::Liftplan;
+using hla::LiftplanHeader;
+using hla::LiftplanParser;
+using hla::LiftplanWriter;
+
+static const std::filesystem::path kDir =
+    std::filesystem::temp_directory_path() / "hla_liftplan_test";
+
+static std::vector<uint8_t> makePicks(int count) {
+    std::vector<uint8_t> picks;
+    for (int i = 0; i < count; ++i) {
+        picks.push_back((i * 37 + i / 7) & 0x3f);
+    }
+    return picks;
+}
+
+static bool writeLiftplan(const std::string& path,
+                          const std::vector<uint8_t>& picks) {
+    LiftplanWriter writer;
+    if (!writer.open(path)) {
+        return false;
+    }
+    for (uint8_t pick : picks) {
+        writer.write(pick);
+    }
+    return writer.close();
+}
+
+static std::vector<char> readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(file), {});
+}
+
+static void writeFile(const std::string& path, const std::vector<char>& data) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(data.data(), data.size());
+}
+
+static void testRoundTrip() {
+    // sizes around the page size of the reader and the chunk size of the
+    // writer
+    for (int count : {0, 1, 255, 256, 257, 600, 5000}) {
+        std::string path = kDir / ("roundtrip.bin");
+        auto picks = makePicks(count);
+        CHECK(writeLiftplan(path, picks));
+
+        auto data = readFile(path);
+        CHECK_EQ(data.size(), sizeof(LiftplanHeader) + count);
+        LiftplanHeader header;
+        memcpy(&header, data.data(), sizeof(header));
+        CHECK(memcmp(header.magic, "HLAP", 4) == 0);
+        CHECK_EQ(header.version, 1);
+        CHECK_EQ(header.pickCount, static_cast<uint32_t>(count));
+        // the number of shafts is the highest one raised by any pick
+        uint8_t used = 0;
+        for (uint8_t pick : picks) {
+            used |= pick;
+        }
+        int shafts = 0;
+        for (; used; used >>= 1) {
+            ++shafts;
+        }
+        CHECK_EQ(header.shaftCount, shafts);
+        CHECK_EQ(header.crc, esp_rom_crc32_le(0, picks.data(), count));
+
+        Liftplan liftplan;
+        CHECK(liftplan.open(path));
+        CHECK_EQ(liftplan.length(), count);
+        for (int i = 0; i < count; ++i) {
+            CHECK_EQ(liftplan.at(i), picks[i]);
+        }
+        // random access goes through the page cache in any order
+        std::mt19937 random(count);
+        for (int i = 0; count && i < 1000; ++i) {
+            int index = random() % count;
+            CHECK_EQ(liftplan.at(index), picks[index]);
+        }
+        CHECK_EQ(liftplan.at(-1), 0);
+        CHECK_EQ(liftplan.at(count), 0);
+    }
+}
+
+static void testCursor() {
+    std::string path = kDir / "cursor.bin";
+    auto picks = makePicks(300);
+    CHECK(writeLiftplan(path, picks));
+    Liftplan liftplan;
+    CHECK(liftplan.open(path));
+    auto cursor = liftplan.cursorAt(299);
+    CHECK(cursor.isValid());
+    CHECK_EQ(cursor.value(), picks[299]);
+    CHECK_EQ(cursor.next().index(), 0);
+    CHECK_EQ(cursor.next().value(), picks[0]);
+    CHECK_EQ(liftplan.cursorAt(0).prev().index(), 299);
+    CHECK(!liftplan.cursorAt(300).isValid());
+    CHECK(!liftplan.cursorAt(-1).isValid());
+    liftplan.close();
+    CHECK_EQ(liftplan.length(), 0);
+    CHECK(!liftplan.cursorAt(0).isValid());
+}
+
+static void testInvalidFiles() {
+    std::string path = kDir / "invalid.bin";
+    Liftplan liftplan;
+    CHECK(!liftplan.open(kDir / "missing.bin"));
+
+    CHECK(writeLiftplan(path, makePicks(600)));
+    auto valid = readFile(path);
+
+    // a corrupted pick is only found by verifying the checksum
+    auto data = valid;
+    data[sizeof(LiftplanHeader) + 300] ^= 0x01;
+    writeFile(path, data);
+    CHECK(!liftplan.open(path));
+    CHECK(liftplan.open(path, false));
+
+    // a truncated file is found by its size
+    data = valid;
+    data.resize(data.size() - 1);
+    writeFile(path, data);
+    CHECK(!liftplan.open(path));
+    CHECK(!liftplan.open(path, false));
+
+    data = valid;
+    data[0] = 'X';
+    writeFile(path, data);
+    CHECK(!liftplan.open(path, false));
+
+    data = valid;
+    data[4] = 2;   // version
+    writeFile(path, data);
+    CHECK(!liftplan.open(path, false));
+
+    data.resize(sizeof(LiftplanHeader) - 1);
+    writeFile(path, data);
+    CHECK(!liftplan.open(path, false));
+    CHECK_EQ(liftplan.length(), 0);
+}
+
+static void testWriterErrors() {
+    LiftplanWriter unopened;
+    CHECK(!unopened.close());
+    LiftplanWriter writer;
+    CHECK(!writer.open(kDir / "missing_dir" / "liftplan.bin"));
+}
+
+static void testJsonToBinary() {
+    // the conversion ConfigStore::saveLiftPlan() does on upload
+    std::string path = kDir / "converted.bin";
+    std::string json = "[\"0x01\", \"0x80\", \"0x3c\"]";
+    LiftplanWriter writer;
+    CHECK(writer.open(path));
+    LiftplanParser parser([&writer](uint8_t pick) { writer.write(pick); });
+    CHECK(parser.feed(json.data(), json.size()));
+    CHECK(parser.isComplete());
+    CHECK(writer.close());
+    Liftplan liftplan;
+    CHECK(liftplan.open(path));
+    CHECK_EQ(liftplan.length(), 3);
+    CHECK_EQ(liftplan.at(0), 0x01);
+    CHECK_EQ(liftplan.at(1), 0x80);
+    CHECK_EQ(liftplan.at(2), 0x3c);
+    LiftplanHeader header;
+    memcpy(&header, readFile(path).data(), sizeof(header));
+    CHECK_EQ(header.shaftCount, 8);
+}
+
+int main() {
+    std::filesystem::remove_all(kDir);
+    std::filesystem::create_directories(kDir);
+    testRoundTrip();
+    testCursor();
+    testInvalidFiles();
+    testWriterErrors();
+    testJsonToBinary();
+    std::filesystem::remove_all(kDir);
+    return hla::test::result();
+}
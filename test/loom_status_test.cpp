@@ -0,0 +1,120 @@
+#include <cstdio>
+#include <cstring>
+
+#include "alloc_counter.h"
+#include "host_test.h"
+#include "json_writer.h"
+#include "loom_status.h"
+
+using hla::ILoom;
+using hla::JsonWriter;
+using hla::WifiInfo;
+using hla::test::allocStats;
+using hla::test::resetAllocStats;
+
+namespace {
+// answers the status queries from fixed strings, like the snapshot of Loom
+class StatusLoom : public ILoom {
+  public:
+    const char* state = "idle";
+    const char* name = "";   // empty if no liftplan is active
+    bool shaftsError = false;
+
+    std::optional<WifiInfo> onGetWifiInfo() const override {
+        return std::nullopt;
+    }
+    void onSetWifiInfo(const WifiInfo&) override {}
+    std::vector<std::string> onGetLiftplans() const override { return {}; }
+    std::optional<size_t> onGetLiftplanSize(const std::string&) override {
+        return std::nullopt;
+    }
+    bool onGetLiftplan(const std::string&, size_t, size_t,
+                       const ChunkWriter&) override {
+        return false;
+    }
+    std::optional<unsigned int>
+    onGetLiftplanPicks(const std::string&, unsigned int, unsigned int,
+                       const PickWriter&) override {
+        return std::nullopt;
+    }
+    bool onSetLiftPlan(const std::string&, const ChunkReader&) override {
+        return false;
+    }
+    bool onDeleteLiftPlan(const std::string&) override { return false; }
+    bool onStart(const std::string&, unsigned int) override { return false; }
+    bool onPause() override { return false; }
+    bool onContinue() override { return false; }
+    bool onStop() override { return false; }
+    bool onSeek(unsigned int) override { return false; }
+    const char* onGetLoomState() const override { return state; }
+    std::optional<unsigned int> onGetActiveLiftplanIndex() const override {
+        return std::nullopt;
+    }
+    bool onGetActiveLiftplanName(char* buffer, size_t size) const override {
+        snprintf(buffer, size, "%s", name);
+        return buffer[0] != '\0';
+    }
+    bool onGetShaftsError() const override { return shaftsError; }
+};
+
+// writes the status the way handleGetLoomStatus() does, into a buffer on the
+// stack passed to the response
+size_t writeStatus(const ILoom& loom, char* response, size_t size) {
+    char buffer[128];
+    size_t length = 0;
+    JsonWriter json(buffer, sizeof(buffer),
+                    [response, &length](const char* data, size_t len,
+                                        bool last) {
+                        memcpy(response, data, len);
+                        length = len;
+                        return last;
+                    });
+    writeLoomStatus(json, loom);
+    CHECK(json.finish());
+    response[length < size ? length : size - 1] = '\0';
+    return length;
+}
+
+void checkStatus(const ILoom& loom, const char* expected) {
+    char response[256];
+    writeStatus(loom, response, sizeof(response));
+    if (strcmp(response, expected) != 0) {
+        fprintf(stderr, "expected %s\n     got %s\n", expected, response);
+        ++hla::test::gFailures;
+    }
+}
+
+void testDocument() {
+    StatusLoom loom;
+    checkStatus(loom, "{\"loom_state\":\"idle\",\"shafts_error\":false}");
+    loom.state = "running";
+    loom.name = "twill.json";
+    loom.shaftsError = true;
+    checkStatus(loom, "{\"loom_state\":\"running\","
+                      "\"active_liftplan\":\"twill.json\","
+                      "\"shafts_error\":true}");
+}
+
+// a name longer than the small string buffer of std::string does not
+// allocate either
+void testNoAllocation() {
+    StatusLoom loom;
+    loom.state = "running";
+    loom.name = "twill_herringbone.json";
+    char response[256];
+    size_t length = 0;
+    resetAllocStats();
+    for (int i = 0; i < 1000; ++i) {
+        length = writeStatus(loom, response, sizeof(response));
+    }
+    CHECK_EQ(allocStats().allocations, 0u);
+    CHECK(strstr(response, "twill_herringbone.json") != nullptr);
+    CHECK(length > 0);
+}
+}   // namespace
+
+int main() {
+    testDocument();
+    testNoAllocation();
+    return hla::test::result();
+}
@@ -0,0 +1,59 @@
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "esp_rom_crc.h"
+#include "host_test.h"
+#include "main_screen.h"
+
+using hla::LoomInfo;
+using hla::LoomState;
+using hla::MainScreen;
+using hla::test::measureUs;
+
+// built twice, against the current Screen and against test/baseline/screen.cpp
+#ifdef SCREEN_BASELINE
+static constexpr const char* kVariant = "baseline";
+#else
+static constexpr const char* kVariant = "current";
+#endif
+
+static constexpr uint16_t kWidth = 128;
+static constexpr uint16_t kHeight = 64;
+static constexpr int kBuilds = 20000;
+// CRC of the frames rendered by the Screen before the glyph table, both
+// variants must match it
+static constexpr uint32_t kExpectedCrc = 0x4474285a;
+
+int main() {
+    MainScreen screen(kWidth, kHeight);
+    screen.setWifiSsid("handloom-workshop")
+        .setUrl("handloom.local")
+        .setLoomPosition(0x55, 0xa3, 0x0f);
+
+    // the frames shown while weaving, idle and paused
+    const LoomInfo infos[] = {
+        LoomInfo(LoomState::Running, "twill_herringbone.json", 1200, 417),
+        LoomInfo(LoomState::Idle, "", 0, 0),
+        LoomInfo(LoomState::Paused, "plain.json", 8, 3),
+    };
+
+    std::vector<uint8_t> frame(kWidth * kHeight / 8);
+    uint32_t crc = 0;
+    for (const auto& info : infos) {
+        screen.setLoomInfo(info).build().copyFrontBuffer(frame.data());
+        crc = esp_rom_crc32_le(crc, frame.data(), frame.size());
+    }
+
+    const int count = sizeof(infos) / sizeof(infos[0]);
+    double us = measureUs([&] {
+        for (int i = 0; i < kBuilds; ++i) {
+            screen.setLoomInfo(infos[i % count]).build();
+        }
+    });
+
+    printf("%-8s MainScreen::build(): %8.2f us/frame, frame crc %08x\n",
+           kVariant, us / kBuilds, static_cast<unsigned>(crc));
+    CHECK(crc == kExpectedCrc);
+    return hla::test::result();
+}
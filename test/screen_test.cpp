@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "host_test.h"
+#include "screen.h"
+
+using hla::Screen;
+
+static constexpr uint16_t kWidth = 128;
+static constexpr uint16_t kHeight = 64;
+static constexpr size_t kFrameSize = kWidth * kHeight / 8;
+
+// each thread renders its own variant, a frame mixing both of them means a
+// build has been read before it was complete or two builds overlapped
+static thread_local int tVariant = 0;
+
+class TestScreen : public Screen {
+  public:
+    TestScreen() : Screen(kWidth, kHeight) {}
+
+  protected:
+    // yields between the drawing steps widen the window in which an
+    // unserialized build would be caught, even on a single core
+    void render() override {
+        clear();
+        std::this_thread::yield();
+        if (tVariant == 0) {
+            printString(0, 0, "VARIANT A");
+            std::this_thread::yield();
+            drawRectangle(0, 20, kWidth, 20, true);
+        } else {
+            StringConfig config;
+            config.size = FontSize::Big;
+            config.align = TextAlign::Right;
+            printString(kWidth - 1, 3, "B", config);
+            std::this_thread::yield();
+            drawRectangle(10, 30, 50, 30, false);
+        }
+    }
+};
+
+static std::vector<uint8_t> buildReference(TestScreen& screen, int variant) {
+    tVariant = variant;
+    screen.build();
+    std::vector<uint8_t> frame(kFrameSize);
+    screen.copyFrontBuffer(frame.data());
+    return frame;
+}
+
+static void testConcurrentBuilds() {
+    TestScreen screen;
+    std::vector<uint8_t> initial(kFrameSize);
+    screen.copyFrontBuffer(initial.data());
+    CHECK(std::all_of(initial.begin(), initial.end(),
+                      [](uint8_t byte) { return byte == 0; }));
+
+    const auto refA = buildReference(screen, 0);
+    const auto refB = buildReference(screen, 1);
+    CHECK(refA != refB);
+    CHECK(refA != initial);
+    CHECK(refB != initial);
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> builds{0};
+    auto writer = [&](int variant) {
+        tVariant = variant;
+        while (!stop) {
+            screen.build();
+            ++builds;
+        }
+    };
+    std::thread writerA(writer, 0);
+    std::thread writerB(writer, 1);
+
+    std::vector<uint8_t> frame(kFrameSize);
+    int torn = 0;
+    int reads = 0;
+    // keep reading until both writers have built plenty of frames
+    for (; builds < 5000; ++reads) {
+        screen.copyFrontBuffer(frame.data());
+        if (frame != refA && frame != refB) {
+            ++torn;
+        }
+        std::this_thread::yield();
+    }
+    stop = true;
+    writerA.join();
+    writerB.join();
+
+    printf("%d builds, %d reads, %d torn frames\n", builds.load(), reads,
+           torn);
+    CHECK_EQ(torn, 0);
+    CHECK(builds > 0);
+}
+
+int main() {
+    testConcurrentBuilds();
+    return hla::test::result();
+}
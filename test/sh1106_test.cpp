@@ -0,0 +1,191 @@
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "driver/i2c_master.h"
+#include "host_test.h"
+#include "sh1106.h"
+
+namespace {
+constexpr int kWidth = 128;
+constexpr int kPages = 8;
+constexpr size_t kFrameSize = kWidth * kPages;
+constexpr size_t kHeaderSize = 7;   // page and column commands, data control
+constexpr uint8_t kColumnOffset = 2;
+
+// a page transmission decoded from the bytes the stub recorded
+struct PageWrite {
+    int page;
+    int column;   // first pixel column
+    std::vector<uint8_t> data;
+};
+
+PageWrite decode(const std::vector<uint8_t>& bytes) {
+    PageWrite write = {-1, -1, {}};
+    if (bytes.size() <= kHeaderSize || bytes[0] != 0x80 || bytes[2] != 0x80 ||
+        bytes[4] != 0x80 || bytes[6] != 0x40) {
+        return write;
+    }
+    write.page = bytes[1] - 0xB0;
+    write.column = ((bytes[3] & 0x0F) | ((bytes[5] & 0x0F) << 4)) -
+                   kColumnOffset;
+    write.data.assign(bytes.begin() + kHeaderSize, bytes.end());
+    return write;
+}
+
+std::vector<PageWrite> pageWrites() {
+    std::vector<PageWrite> writes;
+    for (const auto& bytes : i2c_host_transactions()) {
+        writes.push_back(decode(bytes));
+    }
+    return writes;
+}
+
+// bytes and transactions the display reports for what the stub saw
+void checkCounters(const Sh1106& display, uint32_t transactionsBefore,
+                   bool failed = false) {
+    size_t bytes = 0;
+    for (const auto& write : pageWrites()) {
+        bytes += write.data.size();
+    }
+    CHECK_EQ(display.getTransactionCount() - transactionsBefore,
+             i2c_host_transactions().size());
+    if (!failed) {
+        CHECK_EQ(display.getBytesSent(), bytes);
+    }
+}
+
+Sh1106 gDisplay;
+
+void testInitialize() {
+    i2c_host_clear();
+    gDisplay.initialize(0, GPIO_NUM_21, GPIO_NUM_22);
+    // the whole command sequence goes in one transaction
+    CHECK_EQ(i2c_host_transactions().size(), 1u);
+    CHECK_EQ(i2c_host_transactions()[0][0], 0x00);
+    CHECK_EQ(gDisplay.getTransactionCount(), 1u);
+}
+
+void testFirstFrameIsSentInFull(const uint8_t* frame) {
+    i2c_host_clear();
+    uint32_t before = gDisplay.getTransactionCount();
+    gDisplay.display(frame);
+    auto writes = pageWrites();
+    CHECK_EQ(writes.size(), static_cast<size_t>(kPages));
+    for (int page = 0; page < kPages && page < (int)writes.size(); ++page) {
+        CHECK_EQ(writes[page].page, page);
+        CHECK_EQ(writes[page].column, 0);
+        CHECK_EQ(writes[page].data.size(), static_cast<size_t>(kWidth));
+        CHECK(!memcmp(writes[page].data.data(), frame + page * kWidth,
+                      kWidth));
+    }
+    CHECK_EQ(gDisplay.getBytesSent(), kFrameSize);
+    checkCounters(gDisplay, before);
+}
+
+void testUnchangedFrameSendsNothing(const uint8_t* frame) {
+    i2c_host_clear();
+    uint32_t before = gDisplay.getTransactionCount();
+    gDisplay.display(frame);
+    CHECK_EQ(i2c_host_transactions().size(), 0u);
+    CHECK_EQ(gDisplay.getBytesSent(), 0);
+    checkCounters(gDisplay, before);
+}
+
+void testSinglePixel(uint8_t* frame) {
+    i2c_host_clear();
+    uint32_t before = gDisplay.getTransactionCount();
+    const int page = 5;
+    const int column = 77;
+    frame[page * kWidth + column] ^= 0x10;
+    gDisplay.display(frame);
+    auto writes = pageWrites();
+    CHECK_EQ(writes.size(), 1u);
+    if (writes.size() == 1) {
+        CHECK_EQ(writes[0].page, page);
+        CHECK_EQ(writes[0].column, column);
+        CHECK_EQ(writes[0].data.size(), 1u);
+        CHECK_EQ(writes[0].data[0], frame[page * kWidth + column]);
+    }
+    CHECK_EQ(gDisplay.getBytesSent(), 1);
+    checkCounters(gDisplay, before);
+}
+
+// only the columns between the first and the last change are sent
+void testChangedRange(uint8_t* frame) {
+    i2c_host_clear();
+    frame[2 * kWidth + 10] ^= 0x01;
+    frame[2 * kWidth + 20] ^= 0x80;
+    frame[7 * kWidth + kWidth - 1] ^= 0x01;
+    gDisplay.display(frame);
+    auto writes = pageWrites();
+    CHECK_EQ(writes.size(), 2u);
+    if (writes.size() == 2) {
+        CHECK_EQ(writes[0].page, 2);
+        CHECK_EQ(writes[0].column, 10);
+        CHECK_EQ(writes[0].data.size(), 11u);
+        CHECK(!memcmp(writes[0].data.data(), frame + 2 * kWidth + 10, 11));
+        CHECK_EQ(writes[1].page, 7);
+        CHECK_EQ(writes[1].column, kWidth - 1);
+        CHECK_EQ(writes[1].data.size(), 1u);
+    }
+    CHECK_EQ(gDisplay.getBytesSent(), 12);
+}
+
+void testInvalidate(const uint8_t* frame) {
+    gDisplay.invalidate();
+    testFirstFrameIsSentInFull(frame);
+}
+
+void testFailedTransmit(uint8_t* frame) {
+    // the write of page 3 fails, the other changed page gets through
+    i2c_host_clear();
+    uint32_t before = gDisplay.getTransactionCount();
+    frame[1 * kWidth + 40] ^= 0x02;
+    frame[3 * kWidth + 60] ^= 0x04;
+    i2c_host_fail_at(1);
+    gDisplay.display(frame);
+    auto writes = pageWrites();
+    CHECK_EQ(writes.size(), 2u);
+    if (writes.size() == 2) {
+        CHECK_EQ(writes[1].page, 3);
+    }
+    // the failed bytes are not counted as sent
+    CHECK_EQ(gDisplay.getBytesSent(), 1);
+    checkCounters(gDisplay, before, true);
+
+    // the display content is unknown, the next frame resends the failed page
+    i2c_host_clear();
+    before = gDisplay.getTransactionCount();
+    gDisplay.display(frame);
+    bool resent = false;
+    for (const auto& write : pageWrites()) {
+        if (write.page == 3 && write.column <= 60 &&
+            write.column + (int)write.data.size() > 60) {
+            resent = write.data[60 - write.column] == frame[3 * kWidth + 60];
+        }
+    }
+    CHECK(resent);
+    checkCounters(gDisplay, before);
+
+    // and once it got through, nothing is left to send
+    testUnchangedFrameSendsNothing(frame);
+}
+}   // namespace
+
+int main() {
+    std::vector<uint8_t> frame(kFrameSize);
+    for (size_t i = 0; i < frame.size(); ++i) {
+        frame[i] = (i * 37) & 0xff;
+    }
+    testInitialize();
+    testFirstFrameIsSentInFull(frame.data());
+    testUnchangedFrameSendsNothing(frame.data());
+    testSinglePixel(frame.data());
+    testUnchangedFrameSendsNothing(frame.data());
+    testChangedRange(frame.data());
+    testInvalidate(frame.data());
+    testUnchangedFrameSendsNothing(frame.data());
+    testFailedTransmit(frame.data());
+    return hla::test::result();
+}
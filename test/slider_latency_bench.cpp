@@ -0,0 +1,121 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "host_test.h"
+#include "slider_controller.h"
+#include "slider_simulator.h"
+
+using hla::SliderController;
+using hla::test::SliderSimulator;
+using Clock = SliderSimulator::Clock;
+
+static constexpr int kPresses = 20;
+// time between two presses, the staged positions are acknowledged by then
+static constexpr auto kPressInterval = std::chrono::milliseconds(30);
+
+namespace {
+struct Latency {
+    double toMove = 0;     // until the slider controller starts moving
+    double toReturn = 0;   // until the loom task can go on
+    double toAck = 0;      // until the move is acknowledged
+};
+
+double ms(Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+uint8_t pick(int i) { return (i * 37 + 11) & 0xff; }
+
+// the controller is never deleted, its tasks run until the process exits
+SliderController* connect(SliderSimulator& simulator, uart_port_t port) {
+    uart_host_attach(port, simulator.releaseTerminal());
+    auto* controller = new SliderController(port, GPIO_NUM_17, GPIO_NUM_16);
+    controller->initialize();
+    return controller;
+}
+
+// every press sends the position and waits for the acknowledgement, the way
+// the loom moved the shafts before staging
+Latency pressWithCommands(uint32_t maxBaudRate, uart_port_t port) {
+    SliderSimulator::Options options;
+    options.maxBaudRate = maxBaudRate;
+    SliderSimulator simulator(options);
+    SliderController* controller = connect(simulator, port);
+    CHECK_EQ(controller->getBaudRate(), maxBaudRate);
+
+    Latency latency;
+    size_t moves = simulator.getMoves().size();
+    for (int i = 0; i < kPresses; ++i) {
+        std::this_thread::sleep_for(kPressInterval);
+        auto press = Clock::now();
+        CHECK(controller->sendCommand(pick(i)));
+        auto done = Clock::now();
+        CHECK(simulator.waitForMoves(moves + 1, std::chrono::seconds(1)));
+        auto move = simulator.getMoves()[moves++];
+        CHECK_EQ(move.position, pick(i));
+        latency.toMove += ms(move.start - press);
+        latency.toReturn += ms(done - press);
+        latency.toAck += ms(done - press);
+    }
+    return latency;
+}
+
+// the neighbouring picks are staged after every move, a press only commits
+Latency pressWithStaging(uint32_t maxBaudRate, uart_port_t port) {
+    SliderSimulator::Options options;
+    options.maxBaudRate = maxBaudRate;
+    SliderSimulator simulator(options);
+    SliderController* controller = connect(simulator, port);
+    CHECK_EQ(controller->getBaudRate(), maxBaudRate);
+
+    Latency latency;
+    size_t moves = simulator.getMoves().size();
+    for (int i = 0; i < kPresses; ++i) {
+        CHECK(controller->stage(pick(i + 1), pick(i)));
+        std::this_thread::sleep_for(kPressInterval);
+        std::atomic<bool> acked{false};
+        Clock::time_point ack;
+        auto press = Clock::now();
+        CHECK(controller->commit(SliderController::Direction::Next,
+                                 [&](bool ok) {
+                                     CHECK(ok);
+                                     ack = Clock::now();
+                                     acked = true;
+                                 }));
+        auto done = Clock::now();
+        CHECK(simulator.waitForMoves(moves + 1, std::chrono::seconds(1)));
+        while (!acked) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        auto move = simulator.getMoves()[moves++];
+        CHECK_EQ(move.position, pick(i));
+        CHECK_EQ(move.cmd, 0x40);   // moved by the commit
+        latency.toMove += ms(move.start - press);
+        latency.toReturn += ms(done - press);
+        latency.toAck += ms(ack - press);
+    }
+    return latency;
+}
+
+void report(const char* name, uint32_t baudRate, const Latency& latency) {
+    printf("%-8s %6u baud: press to move %6.2f ms, to return %6.2f ms, "
+           "to ack %6.2f ms\n",
+           name, static_cast<unsigned>(baudRate), latency.toMove / kPresses,
+           latency.toReturn / kPresses, latency.toAck / kPresses);
+}
+}   // namespace
+
+int main() {
+    uart_port_t port = 0;
+    for (uint32_t baudRate : {9600u, 230400u}) {
+        auto commands = pressWithCommands(baudRate, port++);
+        auto staged = pressWithStaging(baudRate, port++);
+        report("command", baudRate, commands);
+        report("staged", baudRate, staged);
+        // a commit returns before the slider controller receives it
+        CHECK(staged.toReturn < commands.toReturn);
+    }
+    return hla::test::result();
+}
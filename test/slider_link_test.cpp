@@ -0,0 +1,184 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "frame_parser.h"
+#include "host_test.h"
+#include "slider_controller.h"
+#include "slider_simulator.h"
+
+using hla::FrameParser;
+using hla::SliderController;
+using hla::test::SliderSimulator;
+
+namespace {
+// requests of the slider protocol, see SliderController
+constexpr uint8_t kStageNextRequest = 0x32;
+constexpr uint8_t kCommitRequest = 0x40;
+
+uart_port_t gNextPort = 0;
+
+// the controller is never deleted, its tasks run until the process exits
+SliderController* connect(SliderSimulator& simulator) {
+    uart_port_t port = gNextPort++;
+    uart_host_attach(port, simulator.releaseTerminal());
+    auto* controller = new SliderController(port, GPIO_NUM_17, GPIO_NUM_16);
+    controller->initialize();
+    return controller;
+}
+
+template <typename Predicate>
+bool waitUntil(Predicate ready, std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!ready()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+// both sides agree on the baud rate and a move goes through
+void checkLink(SliderController* controller, SliderSimulator& simulator,
+               uint32_t baudRate, uint8_t position) {
+    CHECK_EQ(controller->getBaudRate(), baudRate);
+    CHECK_EQ(simulator.getBaudRate(), baudRate);
+    size_t moves = simulator.getMoves().size();
+    CHECK(controller->sendCommand(position));
+    CHECK(simulator.waitForMoves(moves + 1, std::chrono::seconds(1)));
+    CHECK_EQ(simulator.getMoves().back().position, position);
+}
+
+// the table driven CRC8 equals the bitwise one it replaced
+void testCrc8() {
+    uint8_t data[3];
+    for (int i = 0; i < 0x1000000; i += 0x0101) {
+        data[0] = i;
+        data[1] = i >> 8;
+        data[2] = i >> 16;
+        uint8_t crc = 0x00;
+        for (uint8_t byte : data) {
+            crc ^= byte;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1;
+            }
+        }
+        CHECK_EQ(FrameParser::crc8(data, sizeof(data)), crc);
+    }
+}
+
+void testFastestBaudRate() {
+    SliderSimulator simulator({});
+    checkLink(connect(simulator), simulator, 230400, 0x5a);
+}
+
+void testRefusedBaudRate() {
+    SliderSimulator::Options options;
+    options.maxBaudRate = 115200;
+    SliderSimulator simulator(options);
+    checkLink(connect(simulator), simulator, 115200, 0x3c);
+}
+
+// the slider controller acks 230400 but does not switch, both sides fall
+// back to 9600 and agree on the next baud rate
+void testFailedSwitch() {
+    SliderSimulator::Options options;
+    options.brokenBaudRate = 230400;
+    SliderSimulator simulator(options);
+    checkLink(connect(simulator), simulator, 115200, 0x81);
+}
+
+// a slider controller that does not know BaudRateRequest stays at 9600
+void testWithoutNegotiation() {
+    SliderSimulator::Options options;
+    options.baudRates = false;
+    SliderSimulator simulator(options);
+    checkLink(connect(simulator), simulator, 9600, 0x0f);
+}
+
+// a reset slider controller comes back at 9600, the moves time out until the
+// controller negotiates the baud rate again
+void testRenegotiationAfterReset() {
+    SliderSimulator simulator({});
+    SliderController* controller = connect(simulator);
+    controller->setRetryPolicy(pdMS_TO_TICKS(50), 0);
+    checkLink(controller, simulator, 230400, 0x11);
+
+    simulator.reset();
+    CHECK_EQ(simulator.getBaudRate(), 9600u);
+    // the first move fails as a delta and as a position, the renegotiation
+    // starts after the third timeout and drops the link to 9600 at once
+    CHECK(!controller->sendCommand(0x22));
+    CHECK(!controller->sendCommand(0x22));
+    CHECK(waitUntil([&] { return controller->getBaudRate() == 9600; },
+                    std::chrono::milliseconds(100)));
+    // the fallback delay, then a state request, a baud rate request and the
+    // state request that confirms the switch
+    CHECK(waitUntil([&] { return controller->getBaudRate() == 230400; },
+                    std::chrono::seconds(3)));
+    checkLink(controller, simulator, 230400, 0x33);
+}
+
+// the retries of a timed out request carry the same sequence number, the
+// slider controller moves only once
+void testDuplicateIsNotExecuted() {
+    SliderSimulator::Options options;
+    options.moveTime = std::chrono::milliseconds(80);
+    SliderSimulator simulator(options);
+    SliderController* controller = connect(simulator);
+    controller->setRetryPolicy(pdMS_TO_TICKS(50), 2);
+    size_t moves = simulator.getMoves().size();
+    CHECK(controller->sendCommand(0x44));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    CHECK_EQ(simulator.getMoves().size(), moves + 1);
+}
+
+// a lost stage request leaves nothing staged, the commit falls back to a
+// move in the same slot instead of failing into the retry of the loom
+void testLostStageFrame() {
+    SliderSimulator simulator({});
+    SliderController* controller = connect(simulator);
+    checkLink(controller, simulator, 230400, 0x0f);
+    size_t moves = simulator.getMoves().size();
+
+    simulator.dropNext(kStageNextRequest);
+    CHECK(controller->stage(0xf0, 0x3c));
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<int> result{-1};
+    CHECK(controller->commit(SliderController::Next,
+                             [&result](bool ok) { result = ok; }));
+    CHECK(waitUntil([&] { return result >= 0; },
+                    std::chrono::milliseconds(300)));
+    CHECK_EQ(result.load(), 1);
+    // well within the move retry delay of the loom
+    CHECK(std::chrono::steady_clock::now() - start <
+          std::chrono::milliseconds(200));
+    auto executed = simulator.getMoves();
+    CHECK_EQ(executed.size(), moves + 1);
+    CHECK_EQ(executed.back().position, 0x3c);
+    CHECK(executed.back().cmd != kCommitRequest);
+
+    // a single lost frame does not disable staging
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    CHECK(controller->stage(0x3c, 0xc3));
+    CHECK(controller->commit(SliderController::Next, [](bool) {}));
+    CHECK(simulator.waitForMoves(moves + 2, std::chrono::seconds(1)));
+    CHECK_EQ(simulator.getMoves().back().position, 0xc3);
+    CHECK_EQ(simulator.getMoves().back().cmd,
+             kCommitRequest);
+}
+}   // namespace
+
+int main() {
+    testCrc8();
+    testFastestBaudRate();
+    testRefusedBaudRate();
+    testFailedSwitch();
+    testWithoutNegotiation();
+    testRenegotiationAfterReset();
+    testDuplicateIsNotExecuted();
+    testLostStageFrame();
+    return hla::test::result();
+}
@@ -0,0 +1,311 @@
+#include "slider_simulator.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+using hla::FrameParser;
+using hla::test::SliderSimulator;
+
+namespace {
+// messages and status codes of the slider protocol, see SliderController
+enum Message : uint8_t {
+    StateRequest = 0x10,
+    BaudRateRequest = 0x12,
+    CommandRequest = 0x20,
+    StagePrevRequest = 0x30,
+    StageNextRequest = 0x32,
+    CommitRequest = 0x40,
+    DeltaRequest = 0x50,
+};
+enum Status : uint8_t { Ok = 0x00, BadState = 0x01 };
+constexpr uint8_t kReady = 0x02;
+constexpr uint8_t kNext = 0x00;
+
+uint32_t fromSpeed(speed_t speed) {
+    switch (speed) {
+    case B9600:
+        return 9600;
+    case B19200:
+        return 19200;
+    case B38400:
+        return 38400;
+    case B57600:
+        return 57600;
+    case B115200:
+        return 115200;
+    case B230400:
+        return 230400;
+    case B460800:
+        return 460800;
+    case B921600:
+        return 921600;
+    default:
+        return 0;
+    }
+}
+
+uint32_t fromCode(uint8_t code) {
+    switch (code) {
+    case 0x01:
+        return 115200;
+    case 0x02:
+        return 230400;
+    default:
+        return 0;
+    }
+}
+
+// 8N1, a start and a stop bit around every byte
+SliderSimulator::Clock::duration byteTime(uint32_t baudRate) {
+    return std::chrono::nanoseconds(10'000'000'000LL / baudRate);
+}
+}   // namespace
+
+SliderSimulator::SliderSimulator(const Options& options)
+    : mOptions(options), mMaster(-1), mTerminal(-1), mTerminalCopy(-1),
+      mStop(false),
+      mParser([this](const FrameParser::Frame& frame) { onFrame(frame); }),
+      mBaudRate(kDefaultBaudRate), mBaudRateConfirmed(true), mPosition(-1),
+      mStagedPrev(-1), mStagedNext(-1), mLastCmd(-1), mLastSeq(-1),
+      mLastResponse(0) {
+    mMaster = posix_openpt(O_RDWR | O_NOCTTY);
+    if (mMaster < 0 || grantpt(mMaster) || unlockpt(mMaster)) {
+        perror("posix_openpt");
+        abort();
+    }
+    const char* name = ptsname(mMaster);
+    mTerminal = open(name, O_RDWR | O_NOCTTY);
+    mTerminalCopy = open(name, O_RDWR | O_NOCTTY);
+    if (mTerminal < 0 || mTerminalCopy < 0) {
+        perror(name);
+        abort();
+    }
+    termios tio;
+    tcgetattr(mTerminal, &tio);
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, B9600);
+    cfsetospeed(&tio, B9600);
+    tcsetattr(mTerminal, TCSANOW, &tio);
+    mThread = std::thread(&SliderSimulator::run, this);
+}
+
+SliderSimulator::~SliderSimulator() {
+    mStop = true;
+    mThread.join();
+    close(mMaster);
+    close(mTerminalCopy);
+    if (mTerminal >= 0) {
+        close(mTerminal);
+    }
+}
+
+int SliderSimulator::releaseTerminal() {
+    int fd = mTerminal;
+    mTerminal = -1;
+    return fd;
+}
+
+void SliderSimulator::reset() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mBaudRate = kDefaultBaudRate;
+    mBaudRateConfirmed = true;
+    mPosition = -1;
+    mStagedPrev = -1;
+    mStagedNext = -1;
+    mLastCmd = -1;
+    mLastSeq = -1;
+}
+
+void SliderSimulator::dropNext(uint8_t cmd) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mDrops.insert(cmd);
+}
+
+uint32_t SliderSimulator::getBaudRate() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mBaudRate;
+}
+
+std::vector<SliderSimulator::Move> SliderSimulator::getMoves() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mMoves;
+}
+
+bool SliderSimulator::waitForMoves(size_t count,
+                                   std::chrono::milliseconds timeout) const {
+    std::unique_lock<std::mutex> lock(mMutex);
+    return mMoved.wait_for(lock, timeout,
+                           [this, count] { return mMoves.size() >= count; });
+}
+
+void SliderSimulator::run() {
+    // the bytes written by the terminal at once go over the wire one after
+    // the other, each arrives when the previous one is completely received
+    Clock::time_point wireFree = Clock::now();
+    uint8_t buf[64];
+    while (!mStop) {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (!mBaudRateConfirmed && Clock::now() > mFallbackDeadline) {
+                mBaudRate = kDefaultBaudRate;
+                mBaudRateConfirmed = true;
+            }
+        }
+        pollfd fd = {mMaster, POLLIN, 0};
+        if (poll(&fd, 1, 10) <= 0) {
+            continue;
+        }
+        ssize_t len = read(mMaster, buf, sizeof(buf));
+        if (len <= 0) {
+            if (len < 0 && errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        const uint32_t sender = terminalBaudRate();
+        wireFree = std::max(wireFree, Clock::now());
+        for (ssize_t i = 0; i < len; ++i) {
+            wireFree += byteTime(sender);
+            std::this_thread::sleep_until(wireFree);
+            // at the wrong baud rate only line noise is received
+            if (sender == getBaudRate()) {
+                mParser.feed(&buf[i], 1);
+            }
+        }
+    }
+}
+
+void SliderSimulator::onFrame(const FrameParser::Frame& frame) {
+    std::unique_lock<std::mutex> lock(mMutex);
+    auto drop = mDrops.find(frame.cmd);
+    if (drop != mDrops.end()) {
+        mDrops.erase(drop);
+        return;
+    }
+    mBaudRateConfirmed = true;
+    if (frame.cmd == mLastCmd && frame.seq == mLastSeq) {
+        // a retry of a request that is already executed
+        uint8_t response = mLastResponse;
+        lock.unlock();
+        respond(frame.cmd + 1, frame.seq, response);
+        return;
+    }
+    int status = -1;   // unknown requests are not answered
+    int move = -1;
+    uint32_t switchTo = 0;
+    switch (frame.cmd) {
+    case StateRequest:
+        status = kReady;
+        break;
+    case BaudRateRequest:
+        if (!mOptions.baudRates) {
+            break;
+        }
+        switchTo = fromCode(frame.data);
+        status = switchTo && switchTo <= mOptions.maxBaudRate ? Ok : BadState;
+        if (status != Ok || switchTo == mOptions.brokenBaudRate) {
+            switchTo = 0;
+        }
+        break;
+    case CommandRequest:
+        move = frame.data;
+        status = Ok;
+        break;
+    case DeltaRequest:
+        if (!mOptions.delta) {
+            break;
+        }
+        // an empty delta is a probe, anything else needs the position
+        if (frame.data == 0) {
+            status = Ok;
+        } else if (mPosition < 0) {
+            status = BadState;
+        } else {
+            move = mPosition ^ frame.data;
+            status = Ok;
+        }
+        break;
+    case StagePrevRequest:
+    case StageNextRequest:
+        if (!mOptions.staging) {
+            break;
+        }
+        (frame.cmd == StagePrevRequest ? mStagedPrev : mStagedNext) =
+            frame.data;
+        status = Ok;
+        break;
+    case CommitRequest: {
+        if (!mOptions.staging) {
+            break;
+        }
+        int& staged = frame.data == kNext ? mStagedNext : mStagedPrev;
+        if (staged < 0) {
+            status = BadState;
+            break;
+        }
+        move = staged;
+        mStagedPrev = mStagedNext = -1;
+        status = Ok;
+        break;
+    }
+    default:
+        break;
+    }
+    if (status < 0) {
+        return;
+    }
+    mLastCmd = frame.cmd;
+    mLastSeq = frame.seq;
+    mLastResponse = status;
+    lock.unlock();
+
+    if (move >= 0) {
+        this->move(move, frame.cmd);
+    }
+    respond(frame.cmd + 1, frame.seq, status);
+    if (switchTo) {
+        // the switch happens once the response is sent
+        lock.lock();
+        mBaudRate = switchTo;
+        mBaudRateConfirmed = false;
+        mFallbackDeadline = Clock::now() + kFallbackDelay;
+    }
+}
+
+void SliderSimulator::respond(uint8_t cmd, uint8_t seq, uint8_t data) {
+    uint8_t buf[FrameParser::kFrameSize];
+    FrameParser::encode({cmd, seq, data}, buf);
+    const uint32_t baudRate = getBaudRate();
+    std::this_thread::sleep_for(byteTime(baudRate) * sizeof(buf));
+    if (terminalBaudRate() != baudRate) {
+        // the terminal reads line noise
+        std::fill(std::begin(buf), std::end(buf), 0xff);
+    }
+    if (write(mMaster, buf, sizeof(buf)) != sizeof(buf)) {
+        perror("write");
+    }
+}
+
+void SliderSimulator::move(uint8_t position, uint8_t cmd) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mPosition = position;
+        mMoves.push_back({Clock::now(), position, cmd});
+        mMoved.notify_all();
+    }
+    std::this_thread::sleep_for(mOptions.moveTime);
+}
+
+uint32_t SliderSimulator::terminalBaudRate() const {
+    termios tio;
+    if (tcgetattr(mTerminalCopy, &tio)) {
+        return 0;
+    }
+    return fromSpeed(cfgetospeed(&tio));
+}
@@ -0,0 +1,144 @@
+#ifndef slider_simulator_h
+#define slider_simulator_h
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "frame_parser.h"
+
+namespace hla::test {
+/**
+ * @brief Slider controller simulated at the other end of a pty
+ *
+ * The SliderController under test gets the terminal of the pty as its UART
+ * (see uart_host_attach()), the simulator answers on the master side. It
+ * speaks the protocol of the slider controller: state and baud rate
+ * requests, commands, deltas, staged positions and commits, duplicates of
+ * the last request are acknowledged without being executed again.
+ *
+ * The wire is emulated from the baud rate of the terminal. Frames take the
+ * time of 10 bits per byte in both directions, and when the terminal and the
+ * simulator do not use the same baud rate the bytes arrive garbled on both
+ * sides. After switching to a new baud rate the simulator falls back to 9600
+ * baud if no valid frame arrives within the fallback delay, like the
+ * firmware of the slider controller.
+ */
+class SliderSimulator {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Capabilities and behaviour of the simulated slider controller
+     */
+    struct Options {
+        bool baudRates = true;           // knows BaudRateRequest
+        uint32_t maxBaudRate = 230400;   // faster ones are refused
+        uint32_t brokenBaudRate = 0;     // acked, but the switch fails
+        bool staging = true;             // knows staging and commits
+        bool delta = true;               // knows DeltaRequest
+        std::chrono::milliseconds moveTime{0};   // moving before the ack
+    };
+
+    /**
+     * @brief Move executed by the simulator
+     */
+    struct Move {
+        Clock::time_point start;
+        uint8_t position;
+        uint8_t cmd;   // request that caused the move
+    };
+
+    static constexpr uint32_t kDefaultBaudRate = 9600;
+    static constexpr std::chrono::milliseconds kFallbackDelay{500};
+
+    /**
+     * @brief Constructor, opens the pty and starts answering
+     *
+     * @param[in] options Capabilities of the slider controller
+     */
+    explicit SliderSimulator(const Options& options);
+
+    /**
+     * @brief Destructor, closes the master side of the pty
+     */
+    ~SliderSimulator();
+
+    /**
+     * @brief Get the terminal of the pty, for uart_host_attach()
+     * @return file descriptor, owned by the caller
+     */
+    int releaseTerminal();
+
+    /**
+     * @brief Power cycle the slider controller
+     *
+     * It forgets the position and the staged positions and comes back at
+     * 9600 baud.
+     */
+    void reset();
+
+    /**
+     * @brief Lose the next frame of a request on the wire
+     *
+     * @param[in] cmd Request whose next frame is dropped
+     */
+    void dropNext(uint8_t cmd);
+
+    /**
+     * @brief Get baud rate of the simulator
+     * @return baud rate
+     */
+    uint32_t getBaudRate() const;
+
+    /**
+     * @brief Get moves executed so far
+     * @return moves
+     */
+    std::vector<Move> getMoves() const;
+
+    /**
+     * @brief Wait until a number of moves is executed
+     *
+     * @param[in] count Number of moves since the start
+     * @param[in] timeout Maximum time to wait
+     * @return true if the moves are executed in time
+     */
+    bool waitForMoves(size_t count, std::chrono::milliseconds timeout) const;
+
+  private:
+    void run();
+    void onFrame(const FrameParser::Frame& frame);
+    void respond(uint8_t cmd, uint8_t seq, uint8_t data);
+    void move(uint8_t position, uint8_t cmd);
+    uint32_t terminalBaudRate() const;
+
+    Options mOptions;
+    int mMaster;
+    int mTerminal;
+    int mTerminalCopy;   // kept to read the baud rate of the terminal
+    std::atomic<bool> mStop;
+    std::thread mThread;
+    FrameParser mParser;
+
+    mutable std::mutex mMutex;
+    mutable std::condition_variable mMoved;
+    uint32_t mBaudRate;
+    Clock::time_point mFallbackDeadline;   // valid while not yet confirmed
+    bool mBaudRateConfirmed;
+    int mPosition;   // -1 if unknown
+    int mStagedPrev;
+    int mStagedNext;
+    int mLastCmd;   // last request, its duplicates are only acknowledged
+    int mLastSeq;
+    uint8_t mLastResponse;
+    std::vector<Move> mMoves;
+    std::multiset<uint8_t> mDrops;   // requests whose next frame is lost
+};
+}   // namespace hla::test
+#endif   // slider_simulator_h
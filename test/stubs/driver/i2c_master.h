@@ -0,0 +1,65 @@
+#ifndef driver_i2c_master_h
+#define driver_i2c_master_h
+
+// Host replacement of the ESP-IDF I2C master driver. Every transmission is
+// recorded and failures can be injected, see the i2c_host_* functions.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "driver/gpio.h"
+#include "esp_err.h"
+
+typedef int i2c_port_num_t;
+typedef struct i2c_master_bus_t* i2c_master_bus_handle_t;
+typedef struct i2c_master_dev_t* i2c_master_dev_handle_t;
+
+typedef enum { I2C_CLK_SRC_DEFAULT = 0 } i2c_clock_source_t;
+typedef enum { I2C_ADDR_BIT_LEN_7 = 0 } i2c_addr_bit_len_t;
+
+typedef struct {
+    i2c_port_num_t i2c_port;
+    gpio_num_t sda_io_num;
+    gpio_num_t scl_io_num;
+    i2c_clock_source_t clk_source;
+    uint8_t glitch_ignore_cnt;
+    struct {
+        uint32_t enable_internal_pullup : 1;
+    } flags;
+} i2c_master_bus_config_t;
+
+typedef struct {
+    i2c_addr_bit_len_t dev_addr_length;
+    uint16_t device_address;
+    uint32_t scl_speed_hz;
+} i2c_device_config_t;
+
+esp_err_t i2c_new_master_bus(const i2c_master_bus_config_t* config,
+                             i2c_master_bus_handle_t* bus);
+esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t bus,
+                                    const i2c_device_config_t* config,
+                                    i2c_master_dev_handle_t* device);
+esp_err_t i2c_master_transmit(i2c_master_dev_handle_t device,
+                              const uint8_t* buffer, size_t size,
+                              int timeoutMs);
+
+/**
+ * @brief Get the transmissions since the last clear, host only
+ * @return bytes of every transmission, failed ones included
+ */
+const std::vector<std::vector<uint8_t>>& i2c_host_transactions();
+
+/**
+ * @brief Forget the recorded transmissions, host only
+ */
+void i2c_host_clear();
+
+/**
+ * @brief Make a transmission fail, host only
+ *
+ * @param[in] index Index of the transmission since the last clear
+ */
+void i2c_host_fail_at(size_t index);
+
+#endif   // driver_i2c_master_h
@@ -0,0 +1,73 @@
+#ifndef driver_uart_h
+#define driver_uart_h
+
+// Host replacement of the ESP-IDF UART driver. A port is backed by a file
+// descriptor, the terminal of a pty in the tests, attached with
+// uart_host_attach() before the driver is installed. The driver reads the
+// descriptor in a thread and posts UART_DATA events like the real driver.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+typedef int uart_port_t;
+
+#define UART_PIN_NO_CHANGE (-1)
+
+typedef enum { UART_DATA_8_BITS = 0x3 } uart_word_length_t;
+typedef enum { UART_PARITY_DISABLE = 0x0 } uart_parity_t;
+typedef enum { UART_STOP_BITS_1 = 0x1 } uart_stop_bits_t;
+typedef enum { UART_HW_FLOWCTRL_DISABLE = 0x0 } uart_hw_flowcontrol_t;
+
+typedef struct {
+    int baud_rate;
+    uart_word_length_t data_bits;
+    uart_parity_t parity;
+    uart_stop_bits_t stop_bits;
+    uart_hw_flowcontrol_t flow_ctrl;
+} uart_config_t;
+
+typedef enum {
+    UART_DATA,
+    UART_BREAK,
+    UART_BUFFER_FULL,
+    UART_FIFO_OVF,
+    UART_FRAME_ERR,
+    UART_PARITY_ERR,
+    UART_DATA_BREAK,
+    UART_PATTERN_DET,
+    UART_EVENT_MAX
+} uart_event_type_t;
+
+typedef struct {
+    uart_event_type_t type;
+    size_t size;
+    bool timeout_flag;
+} uart_event_t;
+
+/**
+ * @brief Back a port with a file descriptor, host only
+ *
+ * The descriptor is switched to raw mode and owned by the port from now on.
+ *
+ * @param[in] port UART port
+ * @param[in] fd File descriptor of a terminal
+ */
+void uart_host_attach(uart_port_t port, int fd);
+
+esp_err_t uart_param_config(uart_port_t port, const uart_config_t* config);
+esp_err_t uart_set_pin(uart_port_t port, int txPin, int rxPin, int rtsPin,
+                       int ctsPin);
+esp_err_t uart_driver_install(uart_port_t port, int rxBufferSize,
+                              int txBufferSize, int queueSize,
+                              QueueHandle_t* queue, int intrAllocFlags);
+esp_err_t uart_set_baudrate(uart_port_t port, uint32_t baudRate);
+int uart_write_bytes(uart_port_t port, const void* src, size_t size);
+int uart_read_bytes(uart_port_t port, void* buf, uint32_t length,
+                    TickType_t wait);
+esp_err_t uart_flush_input(uart_port_t port);
+
+#endif   // driver_uart_h
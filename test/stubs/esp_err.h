@@ -0,0 +1,30 @@
+#ifndef esp_err_h
+#define esp_err_h
+
+// Host replacement of the ESP-IDF error codes used by the tested modules
+
+#include <cstdio>
+#include <cstdlib>
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+
+inline const char* esp_err_to_name(esp_err_t code) {
+    return code == ESP_OK ? "ESP_OK" : "ESP_FAIL";
+}
+
+#define ESP_ERROR_CHECK(x)                                                     \
+    do {                                                                       \
+        esp_err_t err = (x);                                                   \
+        if (err != ESP_OK) {                                                   \
+            fprintf(stderr, "%s:%d: %s failed (%d)\n", __FILE__, __LINE__,     \
+                    #x, err);                                                  \
+            abort();                                                           \
+        }                                                                      \
+    } while (0)
+
+#endif   // esp_err_h
@@ -0,0 +1,17 @@
+#ifndef esp_log_h
+#define esp_log_h
+
+// Host replacement of the ESP-IDF logging: warnings and errors go to stderr,
+// the rest is dropped to keep the test output readable
+
+#include <cstdio>
+
+#define ESP_LOGE(tag, format, ...)                                             \
+    fprintf(stderr, "E %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...)                                             \
+    fprintf(stderr, "W %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ((void)(tag))
+#define ESP_LOGD(tag, format, ...) ((void)(tag))
+#define ESP_LOGV(tag, format, ...) ((void)(tag))
+
+#endif   // esp_log_h
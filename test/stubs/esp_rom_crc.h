@@ -0,0 +1,16 @@
+#ifndef esp_rom_crc_h
+#define esp_rom_crc_h
+
+#include <cstdint>
+
+/**
+ * @brief CRC32 as computed by the ROM of the ESP32, equal to zlib's crc32()
+ *
+ * @param[in] crc CRC of the preceding data, 0 for the first chunk
+ * @param[in] buf Data
+ * @param[in] len Length of the data
+ * @return CRC of the preceding data and this chunk
+ */
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len);
+
+#endif   // esp_rom_crc_h
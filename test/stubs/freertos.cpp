@@ -0,0 +1,179 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+// Tasks run as detached threads for the rest of the process, like the tasks
+// of the firmware that are never deleted. Waits are mapped to condition
+// variables, a tick is a millisecond.
+
+using Clock = std::chrono::steady_clock;
+
+struct QueueDefinition {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::vector<uint8_t>> items;
+    size_t length;
+    size_t itemSize;
+};
+
+struct SemaphoreDefinition {
+    std::mutex mutex;
+    std::condition_variable changed;
+    int count;
+};
+
+struct tskTaskControlBlock {
+    std::mutex mutex;
+    std::condition_variable notified;
+    uint32_t notifications = 0;
+};
+
+// waits until ready() holds or the ticks elapsed, the lock is held
+template <typename Predicate>
+static bool waitFor(std::condition_variable& cv,
+                    std::unique_lock<std::mutex>& lock, TickType_t wait,
+                    Predicate ready) {
+    if (wait == portMAX_DELAY) {
+        cv.wait(lock, ready);
+        return true;
+    }
+    return cv.wait_for(lock, std::chrono::milliseconds(wait), ready);
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    auto* queue = new QueueDefinition;
+    queue->length = length;
+    queue->itemSize = itemSize;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) { delete queue; }
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t wait) {
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!waitFor(queue->changed, lock, wait,
+                 [queue] { return queue->items.size() < queue->length; })) {
+        return pdFAIL;
+    }
+    auto* bytes = static_cast<const uint8_t*>(item);
+    queue->items.emplace_back(bytes, bytes + queue->itemSize);
+    queue->changed.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t wait) {
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!waitFor(queue->changed, lock, wait,
+                 [queue] { return !queue->items.empty(); })) {
+        return pdFALSE;
+    }
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    queue->items.clear();
+    queue->changed.notify_all();
+    return pdPASS;
+}
+
+static SemaphoreHandle_t createSemaphore(int count) {
+    auto* semaphore = new SemaphoreDefinition;
+    semaphore->count = count;
+    return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() { return createSemaphore(1); }
+
+SemaphoreHandle_t xSemaphoreCreateBinary() { return createSemaphore(0); }
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t*) {
+    return createSemaphore(0);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) { delete semaphore; }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t wait) {
+    std::unique_lock<std::mutex> lock(semaphore->mutex);
+    if (!waitFor(semaphore->changed, lock, wait,
+                 [semaphore] { return semaphore->count > 0; })) {
+        return pdFALSE;
+    }
+    --semaphore->count;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    std::lock_guard<std::mutex> lock(semaphore->mutex);
+    if (semaphore->count > 0) {
+        return pdFALSE;   // binary semaphores and mutexes count up to one
+    }
+    ++semaphore->count;
+    semaphore->changed.notify_one();
+    return pdTRUE;
+}
+
+static thread_local TaskHandle_t tCurrentTask = nullptr;
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char*, uint32_t,
+                       void* param, UBaseType_t, TaskHandle_t* handle) {
+    auto* task = new tskTaskControlBlock;
+    if (handle) {
+        *handle = task;
+    }
+    std::thread([function, param, task] {
+        tCurrentTask = task;
+        function(param);
+    }).detach();
+    return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    // threads not created by xTaskCreate get a control block on first use
+    if (!tCurrentTask) {
+        tCurrentTask = new tskTaskControlBlock;
+    }
+    return tCurrentTask;
+}
+
+TickType_t xTaskGetTickCount() {
+    static const auto start = Clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               Clock::now() - start)
+        .count();
+}
+
+void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    std::lock_guard<std::mutex> lock(task->mutex);
+    ++task->notifications;
+    task->notified.notify_one();
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t wait) {
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(task->mutex);
+    waitFor(task->notified, lock, wait,
+            [task] { return task->notifications > 0; });
+    uint32_t value = task->notifications;
+    if (value > 0) {
+        task->notifications = clearOnExit ? 0 : value - 1;
+    }
+    return value;
+}
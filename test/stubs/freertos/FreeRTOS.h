@@ -0,0 +1,21 @@
+#ifndef freertos_h
+#define freertos_h
+
+// Host replacement of the FreeRTOS API used by the tested modules, tasks are
+// threads and a tick is a millisecond (see freertos.cpp)
+
+#include <cstdint>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+#define portMAX_DELAY static_cast<TickType_t>(0xffffffffUL)
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) static_cast<TickType_t>(ms)
+
+#endif   // freertos_h
@@ -0,0 +1,21 @@
+#ifndef freertos_task_h
+#define freertos_task_h
+
+#include <cstdint>
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct tskTaskControlBlock* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+// the stack depth and the priority are ignored on the host
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name,
+                       uint32_t stackDepth, void* param, UBaseType_t priority,
+                       TaskHandle_t* handle);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+TickType_t xTaskGetTickCount();
+void vTaskDelay(TickType_t ticks);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t wait);
+
+#endif   // freertos_task_h
@@ -0,0 +1,36 @@
+#include <set>
+
+#include "driver/i2c_master.h"
+
+static std::vector<std::vector<uint8_t>> gTransactions;
+static std::set<size_t> gFailures;
+
+esp_err_t i2c_new_master_bus(const i2c_master_bus_config_t*,
+                             i2c_master_bus_handle_t* bus) {
+    *bus = nullptr;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t,
+                                    const i2c_device_config_t*,
+                                    i2c_master_dev_handle_t* device) {
+    *device = nullptr;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_transmit(i2c_master_dev_handle_t, const uint8_t* buffer,
+                              size_t size, int) {
+    gTransactions.emplace_back(buffer, buffer + size);
+    return gFailures.count(gTransactions.size() - 1) ? ESP_FAIL : ESP_OK;
+}
+
+const std::vector<std::vector<uint8_t>>& i2c_host_transactions() {
+    return gTransactions;
+}
+
+void i2c_host_clear() {
+    gTransactions.clear();
+    gFailures.clear();
+}
+
+void i2c_host_fail_at(size_t index) { gFailures.insert(index); }
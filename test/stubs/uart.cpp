@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+
+#include "driver/uart.h"
+
+namespace {
+struct Port {
+    int fd = -1;
+    QueueHandle_t queue = nullptr;
+    std::mutex mutex;
+    std::condition_variable received;
+    std::deque<uint8_t> rx;
+    size_t rxBufferSize = 0;
+};
+
+// never destroyed, the reader threads outlive main()
+std::map<uart_port_t, Port*>& ports() {
+    static auto* ports = new std::map<uart_port_t, Port*>;
+    return *ports;
+}
+
+std::mutex& portsMutex() {
+    static auto* mutex = new std::mutex;
+    return *mutex;
+}
+
+Port* getPort(uart_port_t port) {
+    std::lock_guard<std::mutex> lock(portsMutex());
+    auto it = ports().find(port);
+    return it == ports().end() ? nullptr : it->second;
+}
+
+speed_t toSpeed(uint32_t baudRate) {
+    switch (baudRate) {
+    case 9600:
+        return B9600;
+    case 19200:
+        return B19200;
+    case 38400:
+        return B38400;
+    case 57600:
+        return B57600;
+    case 115200:
+        return B115200;
+    case 230400:
+        return B230400;
+    case 460800:
+        return B460800;
+    case 921600:
+        return B921600;
+    default:
+        return B0;
+    }
+}
+
+void postEvent(Port* port, uart_event_type_t type, size_t size) {
+    uart_event_t event = {type, size, false};
+    xQueueSend(port->queue, &event, 0);
+}
+
+// reads the descriptor until it is closed on the other side
+void readerThread(Port* port) {
+    uint8_t buf[128];
+    while (true) {
+        ssize_t len = read(port->fd, buf, sizeof(buf));
+        if (len < 0 && errno == EINTR) {
+            continue;
+        }
+        if (len <= 0) {
+            return;
+        }
+        bool overflow = false;
+        {
+            std::lock_guard<std::mutex> lock(port->mutex);
+            if (port->rx.size() + len > port->rxBufferSize) {
+                overflow = true;
+            } else {
+                port->rx.insert(port->rx.end(), buf, buf + len);
+            }
+            port->received.notify_all();
+        }
+        postEvent(port, overflow ? UART_BUFFER_FULL : UART_DATA, len);
+    }
+}
+}   // namespace
+
+void uart_host_attach(uart_port_t port, int fd) {
+    termios tio;
+    tcgetattr(fd, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(fd, TCSANOW, &tio);
+    auto* p = new Port;
+    p->fd = fd;
+    std::lock_guard<std::mutex> lock(portsMutex());
+    ports()[port] = p;
+}
+
+esp_err_t uart_param_config(uart_port_t port, const uart_config_t* config) {
+    return uart_set_baudrate(port, config->baud_rate);
+}
+
+esp_err_t uart_set_pin(uart_port_t port, int, int, int, int) {
+    return getPort(port) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t uart_driver_install(uart_port_t port, int rxBufferSize, int,
+                              int queueSize, QueueHandle_t* queue, int) {
+    Port* p = getPort(port);
+    if (!p) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (p->queue) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    p->rxBufferSize = rxBufferSize;
+    p->queue = xQueueCreate(queueSize, sizeof(uart_event_t));
+    if (queue) {
+        *queue = p->queue;
+    }
+    std::thread(readerThread, p).detach();
+    return ESP_OK;
+}
+
+esp_err_t uart_set_baudrate(uart_port_t port, uint32_t baudRate) {
+    Port* p = getPort(port);
+    speed_t speed = toSpeed(baudRate);
+    if (!p || speed == B0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    termios tio;
+    tcgetattr(p->fd, &tio);
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    return tcsetattr(p->fd, TCSANOW, &tio) == 0 ? ESP_OK : ESP_FAIL;
+}
+
+int uart_write_bytes(uart_port_t port, const void* src, size_t size) {
+    Port* p = getPort(port);
+    if (!p) {
+        return -1;
+    }
+    return write(p->fd, src, size);
+}
+
+int uart_read_bytes(uart_port_t port, void* buf, uint32_t length,
+                    TickType_t wait) {
+    Port* p = getPort(port);
+    if (!p) {
+        return -1;
+    }
+    std::unique_lock<std::mutex> lock(p->mutex);
+    auto ready = [p] { return !p->rx.empty(); };
+    if (wait == portMAX_DELAY) {
+        p->received.wait(lock, ready);
+    } else {
+        p->received.wait_for(lock, std::chrono::milliseconds(wait), ready);
+    }
+    size_t len = std::min<size_t>(length, p->rx.size());
+    auto* bytes = static_cast<uint8_t*>(buf);
+    for (size_t i = 0; i < len; ++i) {
+        bytes[i] = p->rx.front();
+        p->rx.pop_front();
+    }
+    return len;
+}
+
+esp_err_t uart_flush_input(uart_port_t port) {
+    Port* p = getPort(port);
+    if (!p) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard<std::mutex> lock(p->mutex);
+    p->rx.clear();
+    return ESP_OK;
+}